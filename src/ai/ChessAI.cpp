@@ -10,11 +10,18 @@ ChessAI::ChessAI(QObject *parent)
     // 创建各个模块
     m_transpositionTable = std::make_unique<TranspositionTable>();
     m_evaluator = std::make_unique<Evaluator>();
+    m_evalCache = std::make_unique<EvalCache>();
     m_moveOrderer = std::make_unique<MoveOrderer>(m_evaluator.get());
     m_searchEngine = std::make_unique<SearchEngine>(m_transpositionTable.get(),
                                                       m_evaluator.get(),
-                                                      m_moveOrderer.get());
-    m_openingBook = std::make_unique<OpeningBook>(m_transpositionTable.get());
+                                                      m_moveOrderer.get(),
+                                                      m_evalCache.get());
+    m_openingBook = std::make_unique<OpeningBook>();
+
+    // 迭代加深每完成一轮就报告进度（在搜索线程中发出，跨线程连接会自动排队）
+    m_searchEngine->setProgressCallback([this](int depth, int nodes) {
+        emit searchProgress(depth, nodes);
+    });
     m_endgameTablebase = std::make_unique<EndgameTablebase>();
 
     qDebug() << "ChessAI 增强版初始化完成";
@@ -54,20 +61,107 @@ int ChessAI::getPruneCount() const
 }
 
 AIMove ChessAI::getBestMove(const Position &position)
+{
+    return getBestMove(position, SearchLimits::fixedDepth(m_maxDepth));
+}
+
+void ChessAI::stop()
+{
+    m_searchEngine->stop();
+}
+
+void ChessAI::recordPonderMove(const Position &position, const AIMove &bestMove)
+{
+    // 并行搜索可能采用辅助线程的结果，此时主线程的变例不以最佳走法开头，不能使用
+    const QList<PVLine> &lines = m_searchEngine->pvLines();
+    if (lines.isEmpty() || lines.first().moves.size() < 2 || lines.first().firstMove() != bestMove) {
+        return;
+    }
+
+    Position next = position;
+    UndoInfo undo;
+    next.makeMove(bestMove, undo);
+    m_ponderMove = lines.first().moves[1];
+    m_ponderKey = next.zobristKey();
+}
+
+AIMove ChessAI::getPonderMove(const Position &position) const
+{
+    // 局面正是上一次搜索的最佳走法走完之后：直接取主要变例中的应着
+    if (m_ponderMove.isValid() && position.zobristKey() == m_ponderKey
+        && ChessRules::isPseudoLegal(position.board(), position.currentTurn(), m_ponderMove)) {
+        Board board = position.board();
+        if (!ChessRules::wouldBeInCheck(board, m_ponderMove.fromRow, m_ponderMove.fromCol,
+                                        m_ponderMove.toRow, m_ponderMove.toCol)) {
+            return m_ponderMove;
+        }
+    }
+
+    // 变例不足两步：上一次搜索的主要变例经过这个局面，置换表中可能保存着它的最佳应着
+    std::optional<AIMove> move = m_transpositionTable->getBestMove(position.zobristKey());
+    if (!move.has_value() || !ChessRules::isPseudoLegal(position.board(), position.currentTurn(), *move)) {
+        return AIMove();
+    }
+
+    // 置换表走法可能来自哈希冲突，确认不会送将
+    Board board = position.board();
+    if (ChessRules::wouldBeInCheck(board, move->fromRow, move->fromCol, move->toRow, move->toCol)) {
+        return AIMove();
+    }
+
+    return AIMove(move->fromRow, move->fromCol, move->toRow, move->toCol);
+}
+
+SearchLimits ChessAI::effectiveLimits(const SearchLimits &limits) const
+{
+    SearchLimits searchLimits = limits;
+    if (searchLimits.depth <= 0 && !searchLimits.hasTimeLimit() && searchLimits.nodes <= 0) {
+        searchLimits.depth = m_maxDepth;
+    }
+    return searchLimits;
+}
+
+QList<PVLine> ChessAI::analyze(const Position &position, const SearchLimits &limits)
 {
     resetStatistics();
+    m_transpositionTable->newSearch();
+
+    SearchLimits searchLimits = effectiveLimits(limits);
+    qDebug() << "=== AI开始分析 ===" << "变例数:" << searchLimits.multiPV;
+
+    // 分析总是使用迭代加深（传统搜索没有变例输出）
+    Position searchPos = position;
+    if (m_searchEngine->isParallelSearchEnabled()) {
+        m_searchEngine->parallelSearch(searchPos, searchLimits);
+    } else {
+        m_searchEngine->iterativeDeepening(searchPos, searchLimits);
+    }
+
+    return m_searchEngine->pvLines();
+}
+
+AIMove ChessAI::getBestMove(const Position &position, const SearchLimits &limits)
+{
+    resetStatistics();
+    m_transpositionTable->newSearch();  // 旧搜索的表项随代数老化，无需清空置换表
+
+    SearchLimits searchLimits = effectiveLimits(limits);
+
     qDebug() << "=== AI开始思考（增强版） ===";
-    qDebug() << "搜索深度:" << m_maxDepth;
+    qDebug() << "搜索深度:" << searchLimits.depth
+             << "用时:" << searchLimits.moveTimeMs << "剩余时间:" << searchLimits.remainingMs
+             << "节点:" << searchLimits.nodes;
 
     PieceColor aiColor = position.currentTurn();
-    bool isMaximizing = (aiColor == PieceColor::Red);
+    m_ponderMove = AIMove();
+    m_ponderKey = 0;
 
     // 创建位置的副本用于搜索
     Position searchPos = position;
 
     // 1. 先尝试查询开局库
     if (m_openingBook && m_openingBook->isEnabled()) {
-        quint64 posKey = m_transpositionTable->computeZobristKey(searchPos);
+        quint64 posKey = searchPos.zobristKey();
         AIMove bookMove = m_openingBook->selectMove(posKey);
         if (bookMove.isValid()) {
             qDebug() << "使用开局库走法";
@@ -76,81 +170,80 @@ AIMove ChessAI::getBestMove(const Position &position)
         }
     }
 
-    // 2. 检查是否进入残局
-    if (m_endgameTablebase && m_endgameTablebase->isEnabled()) {
-        if (m_endgameTablebase->isEndgame(searchPos)) {
-            qDebug() << "进入残局阶段，使用残局评估";
-            // 残局评估会影响Evaluator的评分
-        }
-    }
+    // 2. 局面阶段（评估按阶段在中局与残局之间平滑过渡，搜索中逐节点生效）
+    qDebug() << "局面阶段:" << searchPos.phase() << "/" << PieceSquareTable::TOTAL_PHASE;
 
     AIMove bestMove;
 
     // 3. 使用并行搜索、迭代加深或普通搜索
     if (m_searchEngine->isParallelSearchEnabled()) {
         qDebug() << "使用并行搜索";
-        bestMove = m_searchEngine->parallelSearch(searchPos, m_maxDepth, isMaximizing);
+        bestMove = m_searchEngine->parallelSearch(searchPos, searchLimits);
+        recordPonderMove(position, bestMove);
     } else if (m_searchEngine->isIterativeDeepeningEnabled()) {
         qDebug() << "使用迭代加深搜索";
-        bestMove = m_searchEngine->iterativeDeepening(searchPos, m_maxDepth, isMaximizing);
+        bestMove = m_searchEngine->iterativeDeepening(searchPos, searchLimits);
+        recordPonderMove(position, bestMove);
     } else {
-        // 传统搜索方式
+        // 传统搜索方式（固定深度，时间/节点用尽时返回已搜索走法中最好的一个）
         qDebug() << "使用传统搜索";
+        int depth = searchLimits.depth > 0 ? searchLimits.depth : m_maxDepth;
+        m_searchEngine->startSearch(searchLimits);
 
-        QList<AIMove> allMoves = m_searchEngine->generateAllMoves(searchPos, aiColor);
+        MoveList allMoves;
+        m_searchEngine->generateAllMoves(searchPos, aiColor, allMoves);
 
         if (allMoves.isEmpty()) {
             qDebug() << "没有可用的移动";
             return AIMove();
         }
 
-        quint64 posKey = m_transpositionTable->computeZobristKey(searchPos);
+        quint64 posKey = searchPos.zobristKey();
         std::optional<AIMove> ttMove = m_transpositionTable->getBestMove(posKey);
 
         m_moveOrderer->sortMoves(allMoves, searchPos, 0, ttMove);
 
         constexpr int INF = std::numeric_limits<int>::max() / 2;
-        int bestScore = isMaximizing ? -INF : INF;
+        int bestScore = -INF;  // 以 AI 一方为视角
 
         qDebug() << "评估" << allMoves.size() << "个可能的移动...";
 
         for (int i = 0; i < allMoves.size(); ++i) {
             AIMove &move = allMoves[i];
 
-            Position tempPos = searchPos;
-            tempPos.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-            tempPos.switchTurn();
+            UndoInfo undo;
+            searchPos.makeMove(move, undo);
 
             int score;
             if (i == 0) {
-                score = m_searchEngine->pvs(tempPos, m_maxDepth - 1, -INF, INF, !isMaximizing, true, m_maxDepth);
+                score = -m_searchEngine->pvs(searchPos, depth - 1, -INF, INF, 1, true);
             } else {
-                score = m_searchEngine->pvs(tempPos, m_maxDepth - 1,
-                                           isMaximizing ? bestScore : -INF,
-                                           isMaximizing ? INF : bestScore,
-                                           !isMaximizing, false, m_maxDepth);
+                score = -m_searchEngine->pvs(searchPos, depth - 1, -INF, -bestScore, 1, false);
+            }
+
+            searchPos.unmakeMove(move, undo);
+
+            // 被停止时这一步的分数不完整，第一步都没搜完时仍使用它
+            if (m_searchEngine->isStopped()) {
+                if (!bestMove.isValid()) bestMove = move;
+                break;
             }
 
             move.score = score;
 
-            if (isMaximizing) {
-                if (score > bestScore) {
-                    bestScore = score;
-                    bestMove = move;
-                }
-            } else {
-                if (score < bestScore) {
-                    bestScore = score;
-                    bestMove = move;
-                }
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = move;
             }
 
             if ((i + 1) % 5 == 0 || i == allMoves.size() - 1) {
-                emit searchProgress(m_maxDepth, m_searchEngine->getNodesSearched());
+                emit searchProgress(depth, m_searchEngine->getNodesSearched());
             }
         }
 
-        m_transpositionTable->store(posKey, m_maxDepth, bestScore, TTEntry::EXACT, bestMove);
+        if (!m_searchEngine->isStopped()) {
+            m_transpositionTable->store(posKey, depth, bestScore, TTEntry::EXACT, bestMove);
+        }
 
         qDebug() << "最佳移动:" << bestMove.fromRow << bestMove.fromCol
                  << "->" << bestMove.toRow << bestMove.toCol
@@ -165,7 +258,12 @@ AIMove ChessAI::getBestMove(const Position &position)
     qDebug() << "剪枝次数:" << m_searchEngine->getPruneCount()
              << "置换表命中:" << m_transpositionTable->getHits();
     qDebug() << "空移动剪枝:" << m_searchEngine->getNullMoveCuts()
-             << "LMR减少:" << m_searchEngine->getLmrReductions();
+             << "LMR减少:" << m_searchEngine->getLmrReductions()
+             << "奇异扩展:" << m_searchEngine->getSingularExtensions();
+    int evalProbes = m_searchEngine->getEvalCacheProbes();
+    int evalHits = m_searchEngine->getEvalCacheHits();
+    qDebug() << "评估缓存命中:" << evalHits << "/" << evalProbes
+             << "命中率:" << (evalProbes > 0 ? 100 * evalHits / evalProbes : 0) << "%";
 
     return bestMove;
 }
@@ -215,6 +313,7 @@ void ChessAI::setAdvancedEvaluationEnabled(bool enabled)
 {
     if (m_evaluator) {
         m_evaluator->setAdvancedEvaluationEnabled(enabled);
+        m_evalCache->clear();  // 缓存的是另一种评估的结果
         qDebug() << "高级评估:" << (enabled ? "启用" : "禁用");
     }
 }
@@ -249,3 +348,40 @@ int ChessAI::getThreadCount() const
 {
     return m_searchEngine ? m_searchEngine->getThreadCount() : 0;
 }
+
+void ChessAI::setHashSizeMB(int sizeMB)
+{
+    if (m_transpositionTable) {
+        m_transpositionTable->resize(sizeMB);
+    }
+}
+
+int ChessAI::getHashSizeMB() const
+{
+    return m_transpositionTable ? m_transpositionTable->sizeMB() : 0;
+}
+
+void ChessAI::setEvalCacheSizeMB(int sizeMB)
+{
+    if (m_evalCache) {
+        m_evalCache->resize(sizeMB);
+    }
+}
+
+int ChessAI::getEvalCacheSizeMB() const
+{
+    return m_evalCache ? m_evalCache->sizeMB() : 0;
+}
+
+void ChessAI::setEvalCacheShared(bool shared)
+{
+    if (m_searchEngine) {
+        m_searchEngine->setEvalCacheShared(shared);
+        qDebug() << "评估缓存:" << (shared ? "线程共享" : "每线程独立");
+    }
+}
+
+bool ChessAI::isEvalCacheShared() const
+{
+    return m_searchEngine && m_searchEngine->isEvalCacheShared();
+}
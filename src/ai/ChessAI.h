@@ -4,6 +4,7 @@
 #include "../core/Board.h"
 #include "../core/Position.h"
 #include "TranspositionTable.h"
+#include "EvalCache.h"
 #include "Evaluator.h"
 #include "MoveOrderer.h"
 #include "SearchEngine.h"
@@ -33,9 +34,26 @@ public:
     void setDifficulty(AIDifficulty difficulty);
     AIDifficulty getDifficulty() const { return m_difficulty; }
 
-    // 获取最佳移动
+    // 获取最佳移动（按难度对应的深度搜索）
     AIMove getBestMove(const Position &position);
 
+    // 按搜索限制获取最佳移动（深度/用时/对局时钟/节点数，均未设置时按难度深度搜索）
+    AIMove getBestMove(const Position &position, const SearchLimits &limits);
+
+    // 分析局面：不查开局库，按 limits.multiPV 返回前几个根走法的分数与主要变例（按分数从高到低）
+    QList<PVLine> analyze(const Position &position, const SearchLimits &limits);
+
+    // 请求停止正在进行的搜索（可从其他线程调用，返回最后一轮完整迭代的结果）
+    void stop();
+
+    // 补全搜索限制：没有任何限制时按难度深度搜索，避免无限搜索。
+    // 后台搜索应在启动线程中先取得补全后的限制，搜索线程不再读取难度设置
+    SearchLimits effectiveLimits(const SearchLimits &limits) const;
+
+    // 预测对手在 position（对手走棋）下的应着，用于后台思考（没有可靠预测时返回无效走法）。
+    // 优先取上一次搜索主要变例的第二步，变例不足两步时再查置换表
+    AIMove getPonderMove(const Position &position) const;
+
     // 获取搜索统计信息
     int getNodesSearched() const;
     int getPruneCount() const;
@@ -55,7 +73,7 @@ public:
     void setIterativeDeepeningEnabled(bool enabled);
     bool isIterativeDeepeningEnabled() const;
 
-    // 高级评估
+    // 高级评估（搜索叶子使用完整评估；关闭后只用材料+位置）
     void setAdvancedEvaluationEnabled(bool enabled);
     bool isAdvancedEvaluationEnabled() const;
 
@@ -65,6 +83,16 @@ public:
     void setThreadCount(int count);
     int getThreadCount() const;
 
+    // 置换表大小（MB）
+    void setHashSizeMB(int sizeMB);
+    int getHashSizeMB() const;
+
+    // 评估缓存大小（MB）与模式（共享/每个线程各自一个）
+    void setEvalCacheSizeMB(int sizeMB);
+    int getEvalCacheSizeMB() const;
+    void setEvalCacheShared(bool shared);
+    bool isEvalCacheShared() const;
+
 signals:
     void searchProgress(int depth, int nodes);
     void moveFound(int fromRow, int fromCol, int toRow, int toCol, int score);
@@ -77,10 +105,18 @@ private:
     // 模块组件
     std::unique_ptr<TranspositionTable> m_transpositionTable;
     std::unique_ptr<Evaluator> m_evaluator;
+    std::unique_ptr<EvalCache> m_evalCache;
     std::unique_ptr<MoveOrderer> m_moveOrderer;
     std::unique_ptr<SearchEngine> m_searchEngine;
     std::unique_ptr<OpeningBook> m_openingBook;
     std::unique_ptr<EndgameTablebase> m_endgameTablebase;
+
+    // 上一次搜索主要变例中对手的应着（PV 第二步），以及走完最佳走法后的局面哈希键
+    AIMove m_ponderMove;
+    quint64 m_ponderKey = 0;
+
+    // 搜索结束后从主要变例记录预测应着
+    void recordPonderMove(const Position &position, const AIMove &bestMove);
 };
 
 #endif // CHESSAI_H
@@ -23,9 +23,9 @@ bool EndgameTablebase::isEndgame(const Position &position) const
     int heavyPieces = 0;
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid()) {
-                if (piece->type() == PieceType::Rook || piece->type() == PieceType::Cannon) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY) {
+                if (Board::pieceTypeOf(piece) == PieceType::Rook || Board::pieceTypeOf(piece) == PieceType::Cannon) {
                     heavyPieces++;
                 }
             }
@@ -54,25 +54,32 @@ int EndgameTablebase::evaluateEndgame(const Position &position)
 
 EndgameEntry EndgameTablebase::recognizeSpecialEndgame(const Position &position)
 {
+    // 先查缓存（以局面哈希键为索引）
+    quint64 key = position.zobristKey();
+    auto cached = m_cache.constFind(key);
+    if (cached != m_cache.constEnd()) {
+        return cached.value();
+    }
+
     const Board &board = position.board();
     int totalPieces = countTotalPieces(board);
+    EndgameEntry entry;
 
     // 只剩两个将帅 - 和棋
     if (totalPieces == 2) {
-        return handleKingVsKing(position);
+        entry = handleKingVsKing(position);
     }
-
     // 单车对单子残局
-    if (totalPieces <= 4) {
-        return handleRookVsMinor(position);
+    else if (totalPieces <= 4) {
+        entry = handleRookVsMinor(position);
     }
-
     // 兵类残局
-    if (totalPieces <= 8) {
-        return handlePawnEndgame(position);
+    else if (totalPieces <= 8) {
+        entry = handlePawnEndgame(position);
     }
 
-    return EndgameEntry();
+    m_cache.insert(key, entry);
+    return entry;
 }
 
 int EndgameTablebase::countPieces(const Board &board, PieceColor color) const
@@ -80,8 +87,8 @@ int EndgameTablebase::countPieces(const Board &board, PieceColor color) const
     int count = 0;
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid() && piece->color() == color) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY && Board::pieceColorOf(piece) == color) {
                 count++;
             }
         }
@@ -94,8 +101,8 @@ int EndgameTablebase::countTotalPieces(const Board &board) const
     int count = 0;
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid()) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY) {
                 count++;
             }
         }
@@ -117,9 +124,9 @@ EndgameEntry EndgameTablebase::handleRookVsMinor(const Position &position)
 
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid() && piece->type() == PieceType::Rook) {
-                if (piece->color() == PieceColor::Red) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY && Board::pieceTypeOf(piece) == PieceType::Rook) {
+                if (Board::pieceColorOf(piece) == PieceColor::Red) {
                     redHasRook = true;
                 } else {
                     blackHasRook = true;
@@ -156,22 +163,24 @@ int EndgameTablebase::evaluateKingPawnEndgame(const Position &position)
     // 兵的位置价值在残局中更重要
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid() && piece->type() == PieceType::Pawn) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY && Board::pieceTypeOf(piece) == PieceType::Pawn) {
+                PieceColor color = Board::pieceColorOf(piece);
+
                 // 过河兵价值更高
-                bool isCrossed = (piece->color() == PieceColor::Red && row <= 4) ||
-                                (piece->color() == PieceColor::Black && row >= 5);
+                bool isCrossed = (color == PieceColor::Red && row <= 4) ||
+                                (color == PieceColor::Black && row >= 5);
 
                 int pawnValue = isCrossed ? 150 : 80;
 
                 // 接近对方九宫的兵价值更高
-                if (piece->color() == PieceColor::Red && row <= 2) {
+                if (color == PieceColor::Red && row <= 2) {
                     pawnValue += 50;
-                } else if (piece->color() == PieceColor::Black && row >= 7) {
+                } else if (color == PieceColor::Black && row >= 7) {
                     pawnValue += 50;
                 }
 
-                if (piece->color() == PieceColor::Red) {
+                if (color == PieceColor::Red) {
                     score += pawnValue;
                 } else {
                     score -= pawnValue;
@@ -184,10 +193,11 @@ int EndgameTablebase::evaluateKingPawnEndgame(const Position &position)
     int redKingMoves = 0, blackKingMoves = 0;
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid() && piece->type() == PieceType::King) {
-                QList<QPoint> moves = ChessRules::getLegalMoves(board, row, col);
-                if (piece->color() == PieceColor::Red) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY && Board::pieceTypeOf(piece) == PieceType::King) {
+                MoveList moves;
+                ChessRules::getLegalMoves(board, row, col, moves);
+                if (Board::pieceColorOf(piece) == PieceColor::Red) {
                     redKingMoves = moves.size();
                 } else {
                     blackKingMoves = moves.size();
@@ -209,12 +219,13 @@ int EndgameTablebase::evaluateRookEndgame(const Position &position)
     // 车的活动性非常重要
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid() && piece->type() == PieceType::Rook) {
-                QList<QPoint> moves = ChessRules::getLegalMoves(board, row, col);
+            quint8 piece = board.pieceCode(row, col);
+            if (piece != Board::EMPTY && Board::pieceTypeOf(piece) == PieceType::Rook) {
+                MoveList moves;
+                ChessRules::getLegalMoves(board, row, col, moves);
                 int mobility = moves.size();
 
-                if (piece->color() == PieceColor::Red) {
+                if (Board::pieceColorOf(piece) == PieceColor::Red) {
                     score += mobility * 15;
                 } else {
                     score -= mobility * 15;
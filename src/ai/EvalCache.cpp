@@ -0,0 +1,33 @@
+#include "EvalCache.h"
+#include <QDebug>
+
+EvalCache::EvalCache(int sizeMB)
+    : m_indexMask(0)
+    , m_sizeMB(0)
+{
+    resize(sizeMB);
+}
+
+void EvalCache::resize(int sizeMB)
+{
+    if (sizeMB < 1) sizeMB = 1;
+
+    // 表项数取不超过预算的最大 2 的幂
+    quint64 budget = quint64(sizeMB) * 1024 * 1024 / sizeof(quint64);
+    quint64 count = 1;
+    while (count * 2 <= budget) count *= 2;
+
+    m_entries = std::make_unique<std::atomic<quint64>[]>(count);
+    m_indexMask = count - 1;
+    m_sizeMB = int(count * sizeof(quint64) / (1024 * 1024));
+    clear();
+
+    qDebug() << "评估缓存大小:" << m_sizeMB << "MB," << count << "个表项";
+}
+
+void EvalCache::clear()
+{
+    for (quint64 i = 0; i <= m_indexMask; ++i) {
+        m_entries[i].store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <QtTypes>
+#include <atomic>
+#include <memory>
+
+// 静态评估缓存（无锁、直接映射）
+//
+// 以局面哈希键缓存 Evaluator 的评估结果（红方视角），与置换表分开设定大小。
+// 每个表项只占一个 64 位原子字：高48位为键的高48位，低16位为分数，
+// 读写都是单次原子操作，不会读到撕裂的数据；键不同的局面直接覆盖旧表项。
+// 既可以由所有搜索线程共享，也可以由每个线程各自持有（见 SearchEngine）。
+class EvalCache
+{
+public:
+    static constexpr int DEFAULT_SIZE_MB = 8;
+
+    explicit EvalCache(int sizeMB = DEFAULT_SIZE_MB);
+
+    // 重新分配缓存大小（MB，向下取整到 2 的幂个表项），会清空内容
+    void resize(int sizeMB);
+    int sizeMB() const { return m_sizeMB; }
+
+    // 查询缓存，命中时填充 score
+    bool probe(quint64 key, int &score) const
+    {
+        quint64 data = m_entries[key & m_indexMask].load(std::memory_order_relaxed);
+        if (data == 0 || ((data ^ key) & KEY_MASK) != 0) {
+            return false;
+        }
+        score = qint16(quint16(data));
+        return true;
+    }
+
+    // 存储评估结果（超出 16 位范围的分数不缓存）
+    void store(quint64 key, int score)
+    {
+        if (score < -SCORE_LIMIT || score > SCORE_LIMIT) {
+            return;
+        }
+        quint64 data = (key & KEY_MASK) | quint16(qint16(score));
+        m_entries[key & m_indexMask].store(data, std::memory_order_relaxed);
+    }
+
+    // 清空缓存（评估参数改变后需要调用）
+    void clear();
+
+private:
+    static constexpr quint64 KEY_MASK = ~quint64(0xFFFF);
+    static constexpr int SCORE_LIMIT = 32767;
+
+    std::unique_ptr<std::atomic<quint64>[]> m_entries;
+    quint64 m_indexMask;
+    int m_sizeMB;
+};
+
+#endif // EVALCACHE_H
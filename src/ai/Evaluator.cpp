@@ -1,9 +1,15 @@
 #include "Evaluator.h"
 #include "../core/ChessRules.h"
+#include "../core/PieceSquareTable.h"
 #include <algorithm>
 
 Evaluator::Evaluator()
     : m_useAdvancedEval(true)
+    , m_futilityMargin(150)         // 约一个半兵
+    , m_reverseFutilityMargin(120)
+    , m_lateMoveBase(3)             // 剩余深度1/2/3时分别保留5/11/21个不吃子走法
+    , m_lateMoveFactor(2)
+    , m_structureCache(STRUCTURE_CACHE_MB)
 {
 }
 
@@ -16,32 +22,29 @@ int Evaluator::evaluatePosition(const Position &position)
     }
 }
 
+int Evaluator::evaluatePosition(const Position &position, bool sideInCheck)
+{
+    if (m_useAdvancedEval) {
+        return evaluatePositionFull(position, sideInCheck);
+    } else {
+        return evaluatePositionFast(position, sideInCheck);
+    }
+}
+
 int Evaluator::evaluatePositionFast(const Position &position)
 {
-    int score = 0;
+    return evaluatePositionFast(position,
+                                ChessRules::isInCheck(position.board(), position.currentTurn()));
+}
 
-    // 检查将军状态
-    if (ChessRules::isInCheck(position.board(), PieceColor::Red)) {
-        score -= 50;
-    }
-    if (ChessRules::isInCheck(position.board(), PieceColor::Black)) {
-        score += 50;
-    }
+int Evaluator::evaluatePositionFast(const Position &position, bool sideInCheck)
+{
+    // 材料和位置价值由 Position 走子时增量维护
+    int score = position.materialScore();
 
-    // 计算材料和位置价值
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = position.board().pieceAt(row, col);
-            if (piece && piece->isValid()) {
-                int value = getPieceValue(piece->type(), row, col, piece->color());
-
-                if (piece->color() == PieceColor::Red) {
-                    score += value;
-                } else {
-                    score -= value;
-                }
-            }
-        }
+    // 被将军的一方扣分（只有走子方可能处于被将军状态）
+    if (sideInCheck) {
+        score += (position.currentTurn() == PieceColor::Red) ? -50 : 50;
     }
 
     return score;
@@ -49,266 +52,191 @@ int Evaluator::evaluatePositionFast(const Position &position)
 
 int Evaluator::getPieceBaseValue(PieceType type) const
 {
-    switch (type) {
-    case PieceType::King:
-        return 10000;  // 将/帅
-    case PieceType::Rook:
-        return 1000;   // 车
-    case PieceType::Horse:
-        return 350;    // 马
-    case PieceType::Cannon:
-        return 350;    // 炮
-    case PieceType::Advisor:
-        return 200;    // 士
-    case PieceType::Elephant:
-        return 200;    // 象
-    case PieceType::Pawn:
-        return 100;    // 兵
-    default:
-        return 0;
-    }
+    return PieceSquareTable::baseValue(type);
 }
 
-int Evaluator::getPieceValue(PieceType type, int row, int col, PieceColor color) const
+int Evaluator::staticExchange(const Board &board, const AIMove &move) const
 {
-    int baseValue = getPieceBaseValue(type);
-
-    // 黑方需要翻转行坐标
-    int posRow = (color == PieceColor::Black) ? (9 - row) : row;
-
-    int posValue = 0;
-    switch (type) {
-    case PieceType::Pawn:
-        posValue = PAWN_POS_VALUE[posRow][col];
-        break;
-    case PieceType::Advisor:
-        posValue = ADVISOR_POS_VALUE[posRow][col];
-        break;
-    case PieceType::Elephant:
-        posValue = ELEPHANT_POS_VALUE[posRow][col];
-        break;
-    case PieceType::Horse:
-        posValue = HORSE_POS_VALUE[posRow][col];
-        break;
-    case PieceType::Rook:
-        posValue = ROOK_POS_VALUE[posRow][col];
-        break;
-    case PieceType::Cannon:
-        posValue = CANNON_POS_VALUE[posRow][col];
-        break;
-    case PieceType::King:
-        posValue = KING_POS_VALUE[posRow][col];
-        break;
-    default:
-        break;
-    }
-
-    return baseValue + posValue;
-}
-
-// ============ 位置价值表定义 ============
-
-const int Evaluator::PAWN_POS_VALUE[10][9] = {
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0, -2,  0,  4,  0, -2,  0,  0},
-    { 2,  0,  8,  0,  8,  0,  8,  0,  2},
-    { 6,  12, 18, 18, 20, 18, 18, 12, 6},
-    { 10, 20, 30, 34, 40, 34, 30, 20, 10},
-    { 14, 26, 42, 60, 80, 60, 42, 26, 14},
-    { 18, 36, 56, 80, 120, 80, 56, 36, 18},
-    { 0,  3,  6,  9,  12,  9,  6,  3,  0}
-};
-
-const int Evaluator::ADVISOR_POS_VALUE[10][9] = {
-    { 0,  0,  0, 20,  0, 20,  0,  0,  0},
-    { 0,  0,  0,  0, 23,  0,  0,  0,  0},
-    { 0,  0,  0, 20,  0, 20,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
-};
-
-const int Evaluator::ELEPHANT_POS_VALUE[10][9] = {
-    { 0,  0, 20,  0,  0,  0, 20,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    {18,  0,  0,  0, 23,  0,  0,  0, 18},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0, 20,  0,  0,  0, 20,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
-};
+    int toSq = Board::toSquare(move.toRow, move.toCol);
+    int fromSq = Board::toSquare(move.fromRow, move.fromCol);
+
+    // 在副本上真正走出每一次吃子，吃子后重新查找攻击者：
+    // 吃掉炮架或让开马腿、象眼都会改变下一轮能吃到目标格的棋子
+    Board scratch = board;
+    int gain[32];
+    int count = 1;
+    gain[0] = getPieceBaseValue(Board::pieceTypeOf(scratch.pieceCodeAt(toSq)));
+
+    quint8 occupant = scratch.pieceCodeAt(fromSq);
+    PieceColor side = Board::pieceColorOf(occupant);
+    scratch.makeMove(fromSq, toSq);
+
+    while (count < 32) {
+        side = (side == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+
+        // 价值最小的攻击者
+        BitMask attackers = ChessRules::attackersTo(scratch, toSq, side);
+        int attackerSq = -1;
+        int attackerValue = 0;
+        while (!attackers.isEmpty()) {
+            int sq = attackers.popLowest();
+            int value = getPieceBaseValue(Board::pieceTypeOf(scratch.pieceCodeAt(sq)));
+            if (attackerSq < 0 || value < attackerValue) {
+                attackerSq = sq;
+                attackerValue = value;
+            }
+        }
+        if (attackerSq < 0) {
+            break;
+        }
 
-const int Evaluator::HORSE_POS_VALUE[10][9] = {
-    { 0, -3,  5,  4,  2,  4,  5, -3,  0},
-    {-3,  2,  4,  6,  10, 6,  4,  2, -3},
-    { 4,  6, 12, 11, 15, 11, 12, 6,  4},
-    { 2,  6,  8, 11, 11, 11,  8,  6,  2},
-    { 2,  12, 11, 15, 16, 15, 11, 12, 2},
-    { 0,  5,  7,  7,  14,  7,  7,  5,  0},
-    {-5,  2,  4,  8,  8,  8,  4,  2, -5},
-    {-6,  3,  2,  5,  4,  5,  2,  3, -6},
-    {-8, -3,  1,  4,  4,  4,  1, -3, -8},
-    {-10,-8, -6, -3, -1, -3, -6, -8, -10}
-};
+        // 将帅只能在吃后不被对方吃回时吃子
+        PieceColor enemy = (side == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+        if (Board::pieceTypeOf(scratch.pieceCodeAt(attackerSq)) == PieceType::King) {
+            quint8 captured = scratch.makeMove(attackerSq, toSq);
+            bool recaptured = !ChessRules::attackersTo(scratch, toSq, enemy).isEmpty();
+            scratch.unmakeMove(attackerSq, toSq, captured);
+            if (recaptured) {
+                break;
+            }
+        }
 
-const int Evaluator::ROOK_POS_VALUE[10][9] = {
-    {-6,  5,  8,  8,  8,  8,  8,  5, -6},
-    { 6, 8,   10, 14, 15, 14, 10,  8,  6},
-    { 4,  6,  8,  12, 12, 12,  8,  6,  4},
-    {12, 16, 16, 20, 20, 20, 16, 16, 12},
-    {10, 14, 15, 17, 20, 17, 15, 14, 10},
-    { 6, 11, 13, 15, 16, 15, 13, 11,  6},
-    { 4, 6,   9,  10, 11, 10, 9,   6,  4},
-    { 2, 4,   7,  7,  8,  7,  7,   4,  2},
-    { 0, 3,   5,  5,  6,  5,  5,   3,  0},
-    {-4, 2,   4,  4,  5,  4,  4,   2, -4}
-};
+        // 第 count 次吃子得到目标格上的棋子，减去对方此前的得失
+        gain[count] = getPieceBaseValue(Board::pieceTypeOf(occupant)) - gain[count - 1];
+        occupant = scratch.pieceCodeAt(attackerSq);
+        scratch.makeMove(attackerSq, toSq);
+        ++count;
+    }
 
-const int Evaluator::CANNON_POS_VALUE[10][9] = {
-    { 0,  0,  1,  0,  3,  0,  1,  0,  0},
-    { 0,  2,  4,  3,  4,  3,  4,  2,  0},
-    { 1,  0,  7,  4,  4,  4,  7,  0,  1},
-    { 0,  0,  7,  4,  4,  4,  7,  0,  0},
-    { 0,  1,  6,  7,  7,  7,  6,  1,  0},
-    {-1,  1,  2,  7,  8,  7,  2,  1, -1},
-    { 0,  3,  4,  4,  3,  4,  4,  3,  0},
-    { 0,  2,  2,  2,  2,  2,  2,  2,  0},
-    { 0,  1,  2,  3,  3,  3,  2,  1,  0},
-    { 0,  0,  1,  1,  2,  1,  1,  0,  0}
-};
+    // 倒推：每一方都可以选择不再吃回
+    while (--count > 0) {
+        gain[count - 1] = -std::max(-gain[count - 1], gain[count]);
+    }
+    return gain[0];
+}
 
-const int Evaluator::KING_POS_VALUE[10][9] = {
-    { 0,  0,  0,  8,  8,  8,  0,  0,  0},
-    { 0,  0,  0,  9,  9,  9,  0,  0,  0},
-    { 0,  0,  0, 10, 10, 10,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
-    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
-};
+int Evaluator::getPieceValue(PieceType type, int row, int col, PieceColor color) const
+{
+    return PieceSquareTable::pieceValue(type, row, col, color);
+}
 
 // === 高级评估函数实现 ===
 
 int Evaluator::evaluatePositionFull(const Position &position)
+{
+    return evaluatePositionFull(position,
+                                ChessRules::isInCheck(position.board(), position.currentTurn()));
+}
+
+int Evaluator::evaluatePositionFull(const Position &position, bool sideInCheck)
 {
     int score = 0;
 
     // 基础评估（材料+位置）
-    score += evaluatePositionFast(position);
-
-    // 高级评估因素
-    score += evaluateMobility(position);
-    score += evaluateControl(position);
-    score += evaluateProtection(position);
-    score += evaluateKingSafety(position);
+    score += evaluatePositionFast(position, sideInCheck);
+
+    // 高级评估因素（共用同一张攻击图）
+    AttackMap map;
+    buildAttackMap(position.board(), map);
+
+    // 随局面阶段变化的权重：残局更看重灵活性，将帅受攻击的威胁减半
+    int phase = position.phase();
+    int mobility = evaluateMobility(map);
+    int kingSafety = evaluateKingSafety(position, map);
+
+    score += PieceSquareTable::taper(mobility, mobility * 3 / 2, phase);
+    score += evaluateControl(map);
+    score += evaluateProtection(position, map);
+    score += PieceSquareTable::taper(kingSafety, kingSafety / 2, phase);
+    score += evaluateStructure(position);
     score += evaluatePatterns(position);
 
     return score;
 }
 
-int Evaluator::evaluateMobility(const Position &position)
+void Evaluator::buildAttackMap(const Board &board, AttackMap &map) const
 {
-    const Board &board = position.board();
-    int redMobility = 0, blackMobility = 0;
-
-    // 计算每个棋子的合法移动数
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid()) {
-                QList<QPoint> moves = ChessRules::getLegalMoves(board, row, col);
-                int mobility = moves.size();
-
-                // 根据棋子类型调整权重
-                int weight = 1;
-                if (piece->type() == PieceType::Rook) {
-                    weight = 3;  // 车的灵活性最重要
-                } else if (piece->type() == PieceType::Horse || piece->type() == PieceType::Cannon) {
-                    weight = 2;  // 马炮次之
-                }
+    std::fill(&map.count[0][0], &map.count[0][0] + 2 * Board::SQUARES, quint8(0));
+
+    static const PieceColor colors[2] = {PieceColor::Red, PieceColor::Black};
+    for (int side = 0; side < 2; ++side) {
+        PieceColor color = colors[side];
+        BitMask own = board.colorMask(color);
+        int mobility = 0;
+
+        for (int i = 0; i < board.pieceCount(color); ++i) {
+            int square = board.pieceSquare(color, i);
+            PieceType type = Board::pieceTypeOf(board.pieceCodeAt(square));
+
+            BitMask attacks = ChessRules::attackTargets(board, square);
+
+            // 灵活性：炮不吃子时可走的空位不在攻击范围内，单独计算
+            int moves = (type == PieceType::Cannon)
+                            ? ChessRules::pseudoTargets(board, square).count()
+                            : (attacks & ~own).count();
+
+            // 根据棋子类型调整权重
+            int weight = 1;
+            if (type == PieceType::Rook) {
+                weight = 3;  // 车的灵活性最重要
+            } else if (type == PieceType::Horse || type == PieceType::Cannon) {
+                weight = 2;  // 马炮次之
+            }
+            mobility += moves * weight;
 
-                if (piece->color() == PieceColor::Red) {
-                    redMobility += mobility * weight;
-                } else {
-                    blackMobility += mobility * weight;
-                }
+            while (!attacks.isEmpty()) {
+                ++map.count[side][attacks.popLowest()];
             }
         }
+
+        map.mobility[side] = mobility;
     }
+}
 
-    return (redMobility - blackMobility) * 2;  // 灵活性权重系数
+int Evaluator::evaluateMobility(const AttackMap &map)
+{
+    return (map.mobility[0] - map.mobility[1]) * 2;  // 灵活性权重系数
 }
 
-int Evaluator::evaluateControl(const Position &position)
+int Evaluator::evaluateControl(const AttackMap &map)
 {
-    const Board &board = position.board();
     int redControl = 0, blackControl = 0;
 
-    // 评估对关键格子的控制
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            if (!isKeySquare(row, col)) {
-                continue;
-            }
-
-            // 计算攻击这个格子的双方棋子数
-            int redAttackers = countAttackers(board, row, col, PieceColor::Red);
-            int blackAttackers = countAttackers(board, row, col, PieceColor::Black);
-
-            redControl += redAttackers;
-            blackControl += blackAttackers;
+    // 评估对关键格子的控制（攻击这个格子的双方棋子数）
+    for (int square = 0; square < Board::SQUARES; ++square) {
+        if (!isKeySquare(Board::squareRow(square), Board::squareCol(square))) {
+            continue;
         }
+        redControl += map.count[0][square];
+        blackControl += map.count[1][square];
     }
 
     return (redControl - blackControl) * 3;  // 控制力权重系数
 }
 
-int Evaluator::evaluateProtection(const Position &position)
+int Evaluator::evaluateProtection(const Position &position, const AttackMap &map)
 {
     const Board &board = position.board();
     int score = 0;
 
     // 评估每个棋子的保护情况
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (!piece || !piece->isValid()) {
-                continue;
-            }
+    static const PieceColor colors[2] = {PieceColor::Red, PieceColor::Black};
+    for (int side = 0; side < 2; ++side) {
+        PieceColor color = colors[side];
+        int sign = (side == 0) ? 1 : -1;
 
-            int defenders = countDefenders(board, row, col, piece->color());
-            int attackers = countAttackers(board, row, col,
-                                          piece->color() == PieceColor::Red ? PieceColor::Black : PieceColor::Red);
+        for (int i = 0; i < board.pieceCount(color); ++i) {
+            int square = board.pieceSquare(color, i);
+            int defenders = map.count[side][square];
+            int attackers = map.count[1 - side][square];
 
             // 如果被攻击且无保护，扣分
             if (attackers > 0 && defenders == 0) {
-                int penalty = getPieceBaseValue(piece->type()) / 10;
-                if (piece->color() == PieceColor::Red) {
-                    score -= penalty;
-                } else {
-                    score += penalty;
-                }
+                score -= sign * getPieceBaseValue(Board::pieceTypeOf(board.pieceCodeAt(square))) / 10;
             }
             // 如果有保护，加分
             else if (defenders > attackers) {
-                int bonus = 5 * (defenders - attackers);
-                if (piece->color() == PieceColor::Red) {
-                    score += bonus;
-                } else {
-                    score -= bonus;
-                }
+                score += sign * 5 * (defenders - attackers);
             }
         }
     }
@@ -316,71 +244,78 @@ int Evaluator::evaluateProtection(const Position &position)
     return score;
 }
 
-int Evaluator::evaluateKingSafety(const Position &position)
+int Evaluator::evaluateKingSafety(const Position &position, const AttackMap &map)
 {
     const Board &board = position.board();
     int score = 0;
 
-    // 找到双方的将帅
-    int redKingRow = -1, redKingCol = -1;
-    int blackKingRow = -1, blackKingCol = -1;
-
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (piece && piece->isValid() && piece->type() == PieceType::King) {
-                if (piece->color() == PieceColor::Red) {
-                    redKingRow = row;
-                    redKingCol = col;
-                } else {
-                    blackKingRow = row;
-                    blackKingCol = col;
-                }
-            }
-        }
-    }
-
     // 评估红方将帅安全
-    if (redKingRow >= 0) {
-        int defenders = countDefenders(board, redKingRow, redKingCol, PieceColor::Red);
-        int attackers = countAttackers(board, redKingRow, redKingCol, PieceColor::Black);
+    int redKing = board.kingSquare(PieceColor::Red);
+    if (redKing >= 0) {
+        int defenders = map.count[0][redKing];
+        int attackers = map.count[1][redKing];
 
         score += defenders * 10;
         score -= attackers * 15;
-
-        // 九宫完整性（士象齐全更安全）
-        int advisors = 0, elephants = 0;
-        for (int row = 7; row < 10; ++row) {
-            for (int col = 3; col <= 5; ++col) {
-                const ChessPiece *piece = board.pieceAt(row, col);
-                if (piece && piece->isValid() && piece->color() == PieceColor::Red) {
-                    if (piece->type() == PieceType::Advisor) advisors++;
-                    if (piece->type() == PieceType::Elephant) elephants++;
-                }
-            }
-        }
-        score += advisors * 8 + elephants * 6;
     }
 
     // 评估黑方将帅安全
-    if (blackKingRow >= 0) {
-        int defenders = countDefenders(board, blackKingRow, blackKingCol, PieceColor::Black);
-        int attackers = countAttackers(board, blackKingRow, blackKingCol, PieceColor::Red);
+    int blackKing = board.kingSquare(PieceColor::Black);
+    if (blackKing >= 0) {
+        int defenders = map.count[1][blackKing];
+        int attackers = map.count[0][blackKing];
 
         score -= defenders * 10;
         score += attackers * 15;
+    }
 
+    return score;
+}
+
+int Evaluator::evaluateStructure(const Position &position)
+{
+    int score;
+    if (!m_structureCache.probe(position.structureKey(), score)) {
+        score = computeStructure(position.board());
+        m_structureCache.store(position.structureKey(), score);
+    }
+    return score;
+}
+
+int Evaluator::computeStructure(const Board &board) const
+{
+    int score = 0;
+
+    static const PieceColor colors[2] = {PieceColor::Red, PieceColor::Black};
+    for (int side = 0; side < 2; ++side) {
+        PieceColor color = colors[side];
+        int sign = (side == 0) ? 1 : -1;
+
+        // 九宫完整性（士象齐全更安全）
         int advisors = 0, elephants = 0;
-        for (int row = 0; row < 3; ++row) {
+        int firstRow = (color == PieceColor::Red) ? 7 : 0;
+        for (int row = firstRow; row < firstRow + 3; ++row) {
             for (int col = 3; col <= 5; ++col) {
-                const ChessPiece *piece = board.pieceAt(row, col);
-                if (piece && piece->isValid() && piece->color() == PieceColor::Black) {
-                    if (piece->type() == PieceType::Advisor) advisors++;
-                    if (piece->type() == PieceType::Elephant) elephants++;
+                quint8 piece = board.pieceCode(row, col);
+                if (piece != Board::EMPTY && Board::pieceColorOf(piece) == color) {
+                    if (Board::pieceTypeOf(piece) == PieceType::Advisor) advisors++;
+                    if (Board::pieceTypeOf(piece) == PieceType::Elephant) elephants++;
                 }
             }
         }
-        score -= advisors * 8 + elephants * 6;
+        score += sign * (advisors * 8 + elephants * 6);
+
+        // 连兵：过河的兵左右相邻，互相保护
+        const quint8 pawn = Board::makePieceCode(PieceType::Pawn, color);
+        for (int i = 0; i < board.pieceCount(color); ++i) {
+            int square = board.pieceSquare(color, i);
+            int row = Board::squareRow(square);
+            int col = Board::squareCol(square);
+            if (board.pieceCodeAt(square) == pawn && col + 1 < Board::COLS
+                && !Board::isInOwnHalf(row, col, color) && board.pieceCode(row, col + 1) == pawn) {
+                score += sign * 15;
+            }
+        }
     }
 
     return score;
@@ -394,21 +329,22 @@ int Evaluator::evaluatePatterns(const Position &position)
     // 识别特殊棋型（马后炮、重炮等）
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = board.pieceAt(row, col);
-            if (!piece || !piece->isValid()) {
+            quint8 piece = board.pieceCode(row, col);
+            if (piece == Board::EMPTY) {
                 continue;
             }
+            PieceColor color = Board::pieceColorOf(piece);
 
             // 马后炮：炮在马后面
-            if (piece->type() == PieceType::Cannon) {
+            if (Board::pieceTypeOf(piece) == PieceType::Cannon) {
                 // 检查炮前方是否有己方马
-                int direction = (piece->color() == PieceColor::Red) ? -1 : 1;
+                int direction = (color == PieceColor::Red) ? -1 : 1;
                 for (int r = row + direction; r >= 0 && r < Board::ROWS; r += direction) {
-                    const ChessPiece *front = board.pieceAt(r, col);
-                    if (front && front->isValid()) {
-                        if (front->color() == piece->color() && front->type() == PieceType::Horse) {
+                    quint8 front = board.pieceCode(r, col);
+                    if (front != Board::EMPTY) {
+                        if (Board::pieceColorOf(front) == color && Board::pieceTypeOf(front) == PieceType::Horse) {
                             int bonus = 30;
-                            if (piece->color() == PieceColor::Red) {
+                            if (color == PieceColor::Red) {
                                 score += bonus;
                             } else {
                                 score -= bonus;
@@ -420,16 +356,16 @@ int Evaluator::evaluatePatterns(const Position &position)
             }
 
             // 双车联动
-            if (piece->type() == PieceType::Rook) {
+            if (Board::pieceTypeOf(piece) == PieceType::Rook) {
                 // 检查同一行或列是否有另一个己方车
                 for (int c = 0; c < Board::COLS; ++c) {
                     if (c == col) continue;
-                    const ChessPiece *other = board.pieceAt(row, c);
-                    if (other && other->isValid() &&
-                        other->color() == piece->color() &&
-                        other->type() == PieceType::Rook) {
+                    quint8 other = board.pieceCode(row, c);
+                    if (other != Board::EMPTY &&
+                        Board::pieceColorOf(other) == color &&
+                        Board::pieceTypeOf(other) == PieceType::Rook) {
                         int bonus = 40;
-                        if (piece->color() == PieceColor::Red) {
+                        if (color == PieceColor::Red) {
                             score += bonus;
                         } else {
                             score -= bonus;
@@ -444,36 +380,6 @@ int Evaluator::evaluatePatterns(const Position &position)
     return score;
 }
 
-int Evaluator::countAttackers(const Board &board, int row, int col, PieceColor attackColor)
-{
-    int count = 0;
-
-    // 检查所有敌方棋子是否能攻击到这个位置
-    for (int r = 0; r < Board::ROWS; ++r) {
-        for (int c = 0; c < Board::COLS; ++c) {
-            const ChessPiece *piece = board.pieceAt(r, c);
-            if (!piece || !piece->isValid() || piece->color() != attackColor) {
-                continue;
-            }
-
-            QList<QPoint> moves = ChessRules::getLegalMoves(board, r, c);
-            for (const QPoint &move : moves) {
-                if (move.y() == row && move.x() == col) {
-                    count++;
-                    break;
-                }
-            }
-        }
-    }
-
-    return count;
-}
-
-int Evaluator::countDefenders(const Board &board, int row, int col, PieceColor defendColor)
-{
-    return countAttackers(board, row, col, defendColor);
-}
-
 bool Evaluator::isKeySquare(int row, int col)
 {
     return KEY_SQUARES[row][col];
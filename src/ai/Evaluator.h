@@ -4,6 +4,7 @@
 #include "../core/Board.h"
 #include "../core/Position.h"
 #include "../core/ChessPiece.h"
+#include "EvalCache.h"
 #include <QList>
 #include <QPoint>
 
@@ -16,56 +17,100 @@ public:
     // 评估局面（正数表示红方优势，负数表示黑方优势）
     int evaluatePosition(const Position &position);
 
-    // 快速评估（仅材料+位置）
+    // 评估局面，走子方是否被将军由调用方给出（搜索叶子使用）
+    int evaluatePosition(const Position &position, bool sideInCheck);
+
+    // 快速评估（仅材料+位置，按局面阶段在中局与残局之间插值）
     int evaluatePositionFast(const Position &position);
 
+    // 快速评估，走子方是否被将军由调用方给出（搜索中已经算过，避免重复检测）
+    int evaluatePositionFast(const Position &position, bool sideInCheck);
+
     // 完整评估（包含所有因素）
     int evaluatePositionFull(const Position &position);
+    int evaluatePositionFull(const Position &position, bool sideInCheck);
 
-    // 获取棋子基础价值
+    // 获取棋子基础价值（中局）
     int getPieceBaseValue(PieceType type) const;
 
-    // 获取棋子总价值（基础价值+位置价值）
+    // 静态交换评估（SEE）：双方在 move 的目标格上轮流用价值最小的子吃回，
+    // 任何一方都可以在不利时停止，返回走子方的净得失（不检查牵制送将）
+    int staticExchange(const Board &board, const AIMove &move) const;
+
+    // 获取棋子总价值（基础价值+中局位置价值）
     int getPieceValue(PieceType type, int row, int col, PieceColor color) const;
 
     // 启用/禁用高级评估
     void setAdvancedEvaluationEnabled(bool enabled) { m_useAdvancedEval = enabled; }
     bool isAdvancedEvaluationEnabled() const { return m_useAdvancedEval; }
 
+    // === 浅层剪枝边界（与评估分数同一尺度，搜索在剩余深度不超过 MAX_PRUNING_DEPTH 时使用） ===
+
+    static constexpr int MAX_PRUNING_DEPTH = 3;
+
+    // 前向剪枝：静态评估加上边界仍不超过 alpha 时，不吃子也不将军的走法不再搜索
+    int futilityMargin(int depth) const { return m_futilityMargin * depth; }
+
+    // 反向前向剪枝：静态评估减去边界仍不低于 beta 时，直接返回静态评估
+    int reverseFutilityMargin(int depth) const { return m_reverseFutilityMargin * depth; }
+
+    // 后期走法剪枝：已搜索的不吃子走法超过这个数目后，其余不吃子走法不再搜索
+    int lateMoveCount(int depth) const { return m_lateMoveBase + m_lateMoveFactor * depth * depth; }
+
+    // 调整剪枝边界（每层边界、每层边界、走法数 = base + factor * depth²）
+    void setPruningMargins(int futility, int reverseFutility, int lateMoveBase, int lateMoveFactor) {
+        m_futilityMargin = futility;
+        m_reverseFutilityMargin = reverseFutility;
+        m_lateMoveBase = lateMoveBase;
+        m_lateMoveFactor = lateMoveFactor;
+    }
+
 private:
+    // 双方的攻击图：一次遍历全部棋子得到，供各项高级评估共用
+    struct AttackMap {
+        quint8 count[2][Board::SQUARES];  // [红/黑][格子]：攻击该格的棋子数（己方棋子所在格即保护数）
+        int mobility[2];                  // 按棋子类型加权的伪合法走法数
+    };
+
+    // 构建攻击图
+    void buildAttackMap(const Board &board, AttackMap &map) const;
+
     // === 高级评估因素 ===
 
     // 评估棋子灵活性（mobility）
-    int evaluateMobility(const Position &position);
+    int evaluateMobility(const AttackMap &map);
 
     // 评估控制力（对关键格子的控制）
-    int evaluateControl(const Position &position);
+    int evaluateControl(const AttackMap &map);
 
     // 评估棋子保护关系
-    int evaluateProtection(const Position &position);
+    int evaluateProtection(const Position &position, const AttackMap &map);
+
+    // 评估将帅安全性（将帅受到的攻击与保护，九宫结构见 evaluateStructure）
+    int evaluateKingSafety(const Position &position, const AttackMap &map);
 
-    // 评估将帅安全性
-    int evaluateKingSafety(const Position &position);
+    // 评估兵型和九宫结构（只取决于士、象、兵，按结构哈希缓存）
+    int evaluateStructure(const Position &position);
+    int computeStructure(const Board &board) const;
 
     // 评估棋型��特殊棋型奖励）
     int evaluatePatterns(const Position &position);
 
     // 辅助函数
-    int countAttackers(const Board &board, int row, int col, PieceColor attackColor);
-    int countDefenders(const Board &board, int row, int col, PieceColor defendColor);
     bool isKeySquare(int row, int col);  // 判断是否是关键格子
 
     // 选项
     bool m_useAdvancedEval;
 
-    // 位置价值表（红方视角，黑方需要翻转）
-    static const int PAWN_POS_VALUE[10][9];
-    static const int ADVISOR_POS_VALUE[10][9];
-    static const int ELEPHANT_POS_VALUE[10][9];
-    static const int HORSE_POS_VALUE[10][9];
-    static const int ROOK_POS_VALUE[10][9];
-    static const int CANNON_POS_VALUE[10][9];
-    static const int KING_POS_VALUE[10][9];
+    // 剪枝边界
+    int m_futilityMargin;
+    int m_reverseFutilityMargin;
+    int m_lateMoveBase;
+    int m_lateMoveFactor;
+
+    // 结构评估缓存（各搜索线程共享，结构很少变化，小容量即可）
+    static constexpr int STRUCTURE_CACHE_MB = 1;
+    EvalCache m_structureCache;
 
     // 关键格子定义（九宫、河口等）
     static const bool KEY_SQUARES[10][9];
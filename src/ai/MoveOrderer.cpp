@@ -7,7 +7,7 @@ MoveOrderer::MoveOrderer(Evaluator *evaluator)
     reset();
 }
 
-void MoveOrderer::sortMoves(QList<AIMove> &moves, const Position &position, int depth, const std::optional<AIMove> &ttMove)
+void MoveOrderer::sortMoves(MoveList &moves, const Position &position, int depth, const std::optional<AIMove> &ttMove)
 {
     // 使用快速评估给每个移动打分
     for (AIMove &move : moves) {
@@ -25,47 +25,54 @@ int MoveOrderer::quickEvaluateMove(const Position &position, const AIMove &move,
     int score = 0;
 
     // 1. 置换表移动（最高优先级）
-    if (ttMove.has_value() && ttMove->fromRow == move.fromRow && ttMove->fromCol == move.fromCol &&
-        ttMove->toRow == move.toRow && ttMove->toCol == move.toCol) {
+    if (ttMove.has_value() && *ttMove == move) {
         return 1000000;
     }
 
     // 2. 杀手移动
-    if (depth < 10) {
-        if ((m_killerMoves[depth][0].fromRow == move.fromRow && m_killerMoves[depth][0].fromCol == move.fromCol &&
-             m_killerMoves[depth][0].toRow == move.toRow && m_killerMoves[depth][0].toCol == move.toCol) ||
-            (m_killerMoves[depth][1].fromRow == move.fromRow && m_killerMoves[depth][1].fromCol == move.fromCol &&
-             m_killerMoves[depth][1].toRow == move.toRow && m_killerMoves[depth][1].toCol == move.toCol)) {
-            score += 500000;
-        }
+    if (depth < 10 && (m_killerMoves[depth][0] == move || m_killerMoves[depth][1] == move)) {
+        score += 500000;
     }
 
-    // 3. MVV-LVA（Most Valuable Victim - Least Valuable Attacker）
-    const ChessPiece *target = position.board().pieceAt(move.toRow, move.toCol);
-    if (target && target->isValid()) {
-        const ChessPiece *attacker = position.board().pieceAt(move.fromRow, move.fromCol);
-        if (attacker && attacker->isValid()) {
-            score += m_evaluator->getPieceBaseValue(target->type()) * 10
-                   - m_evaluator->getPieceBaseValue(attacker->type());
-        }
+    // 3. 吃子：不亏的吃子排在杀手之前，其间按 MVV-LVA（Most Valuable Victim - Least Valuable Attacker），
+    //    会亏子的吃子（静态交换为负）按亏损排到不吃子走法之后
+    if (!position.board().isEmpty(move.toRow, move.toCol)) {
+        int exchange = exchangeScore(position, move);
+        score += exchange >= 0 ? 600000 + captureScore(position, move) : exchange;
     }
 
     // 4. 历史启发
-    score += m_historyTable[move.fromRow][move.fromCol][move.toRow][move.toCol];
+    score += historyScore(move);
 
     return score;
 }
 
+int MoveOrderer::captureScore(const Position &position, const AIMove &move) const
+{
+    quint8 target = position.board().pieceCode(move.toRow, move.toCol);
+    quint8 attacker = position.board().pieceCode(move.fromRow, move.fromCol);
+    if (target == Board::EMPTY || attacker == Board::EMPTY) {
+        return 0;
+    }
+
+    return m_evaluator->getPieceBaseValue(Board::pieceTypeOf(target)) * 10
+         - m_evaluator->getPieceBaseValue(Board::pieceTypeOf(attacker));
+}
+
+int MoveOrderer::exchangeScore(const Position &position, const AIMove &move) const
+{
+    if (position.board().isEmpty(move.toRow, move.toCol)) {
+        return 0;
+    }
+    return m_evaluator->staticExchange(position.board(), move);
+}
+
 void MoveOrderer::updateKillerMove(const AIMove &move, int depth)
 {
     if (depth >= 10) return;
 
     // 如果不是当前第一个杀手移动，则更新
-    if (m_killerMoves[depth][0].fromRow != move.fromRow ||
-        m_killerMoves[depth][0].fromCol != move.fromCol ||
-        m_killerMoves[depth][0].toRow != move.toRow ||
-        m_killerMoves[depth][0].toCol != move.toCol) {
-
+    if (!(m_killerMoves[depth][0] == move)) {
         m_killerMoves[depth][1] = m_killerMoves[depth][0];
         m_killerMoves[depth][0] = move;
     }
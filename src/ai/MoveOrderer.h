@@ -4,6 +4,7 @@
 #include "TranspositionTable.h"
 #include "Evaluator.h"
 #include "../core/Position.h"
+#include "../core/MoveList.h"
 #include <QList>
 #include <cstring>
 #include <optional>
@@ -15,7 +16,7 @@ public:
     MoveOrderer(Evaluator *evaluator);
 
     // 对移动列表进行排序
-    void sortMoves(QList<AIMove> &moves, const Position &position, int depth, const std::optional<AIMove> &ttMove = std::nullopt);
+    void sortMoves(MoveList &moves, const Position &position, int depth, const std::optional<AIMove> &ttMove = std::nullopt);
 
     // 更新杀手移动
     void updateKillerMove(const AIMove &move, int depth);
@@ -26,6 +27,22 @@ public:
     // 重置所有启发式数据
     void reset();
 
+    // 吃子走法的 MVV-LVA 分数（不吃子返回0）
+    int captureScore(const Position &position, const AIMove &move) const;
+
+    // 吃子走法的静态交换得失（SEE，不吃子返回0）
+    int exchangeScore(const Position &position, const AIMove &move) const;
+
+    // 历史启发分数
+    int historyScore(const AIMove &move) const {
+        return m_historyTable[move.fromRow][move.fromCol][move.toRow][move.toCol];
+    }
+
+    // 第 depth 层的第 index 个杀手移动（超出范围返回无效走法）
+    AIMove killerMove(int depth, int index) const {
+        return depth < 10 ? m_killerMoves[depth][index] : AIMove();
+    }
+
 private:
     // 快速评估移动价值（用于排序）
     int quickEvaluateMove(const Position &position, const AIMove &move, int depth, const std::optional<AIMove> &ttMove);
@@ -0,0 +1,127 @@
+#include "MovePicker.h"
+
+MovePicker::MovePicker(const Position &position, const MoveOrderer *orderer, int ply,
+                       const std::optional<AIMove> &ttMove)
+    : m_position(position)
+    , m_orderer(orderer)
+    , m_color(position.currentTurn())
+    , m_stage(Stage::TTMove)
+    , m_killerIndex(0)
+    , m_index(0)
+    , m_badIndex(0)
+{
+    // 置换表走法可能来自哈希冲突，先确认在当前局面可走
+    if (ttMove.has_value() && ChessRules::isPseudoLegal(position.board(), m_color, *ttMove)) {
+        m_ttMove = *ttMove;
+    }
+
+    m_killers[0] = orderer->killerMove(ply, 0);
+    m_killers[1] = orderer->killerMove(ply, 1);
+}
+
+bool MovePicker::next(AIMove &move)
+{
+    switch (m_stage) {
+    case Stage::TTMove:
+        m_stage = Stage::GenerateCaptures;
+        if (m_ttMove.isValid()) {
+            move = m_ttMove;
+            return true;
+        }
+        [[fallthrough]];
+
+    case Stage::GenerateCaptures:
+        generate(MoveGenType::Captures);
+        m_stage = Stage::Captures;
+        [[fallthrough]];
+
+    case Stage::Captures:
+        while (m_index < m_moves.size()) {
+            move = pickBest();
+            // 会亏子的吃子推迟到不吃子走法之后
+            if (m_orderer->exchangeScore(m_position, move) < 0) {
+                m_badCaptures.append(move);
+                continue;
+            }
+            return true;
+        }
+        m_stage = Stage::Killers;
+        [[fallthrough]];
+
+    case Stage::Killers:
+        // 杀手走法只在当前局面是可走的不吃子走法时使用
+        while (m_killerIndex < 2) {
+            const AIMove &killer = m_killers[m_killerIndex++];
+            if (killer.isValid() && !(killer == m_ttMove)
+                && ChessRules::isPseudoLegal(m_position.board(), m_color, killer)
+                && m_position.board().isEmpty(killer.toRow, killer.toCol)) {
+                move = killer;
+                return true;
+            }
+        }
+        m_stage = Stage::GenerateQuiets;
+        [[fallthrough]];
+
+    case Stage::GenerateQuiets:
+        generate(MoveGenType::Quiets);
+        m_stage = Stage::Quiets;
+        [[fallthrough]];
+
+    case Stage::Quiets:
+        if (m_index < m_moves.size()) {
+            move = pickBest();
+            return true;
+        }
+        m_stage = Stage::BadCaptures;
+        [[fallthrough]];
+
+    case Stage::BadCaptures:
+        if (m_badIndex < m_badCaptures.size()) {
+            move = m_badCaptures[m_badIndex++];
+            return true;
+        }
+        m_stage = Stage::Done;
+        [[fallthrough]];
+
+    case Stage::Done:
+        break;
+    }
+
+    return false;
+}
+
+void MovePicker::generate(MoveGenType type)
+{
+    MoveList generated;
+    ChessRules::generatePseudoLegalMoves(m_position.board(), m_color, generated, type);
+
+    m_moves.clear();
+    m_index = 0;
+    for (AIMove &move : generated) {
+        if (move == m_ttMove)
+            continue;
+
+        if (type == MoveGenType::Captures) {
+            move.score = m_orderer->captureScore(m_position, move);
+        } else {
+            // 杀手走法若可走，已在杀手阶段给出
+            if (move == m_killers[0] || move == m_killers[1])
+                continue;
+            move.score = m_orderer->historyScore(move);
+        }
+        m_moves.append(move);
+    }
+}
+
+AIMove MovePicker::pickBest()
+{
+    int best = m_index;
+    for (int i = m_index + 1; i < m_moves.size(); ++i) {
+        if (m_moves[i].score > m_moves[best].score) {
+            best = i;
+        }
+    }
+
+    std::swap(m_moves[m_index], m_moves[best]);
+    return m_moves[m_index++];
+}
@@ -0,0 +1,60 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "MoveOrderer.h"
+#include "../core/Position.h"
+#include "../core/ChessRules.h"
+#include "../core/MoveList.h"
+#include <optional>
+
+// 分阶段走法选择器
+//
+// 按"置换表走法 → 不亏的吃子（MVV-LVA）→ 杀手走法 → 不吃子（历史分数）→ 亏子的吃子"的顺序逐个给出走法。
+// 上一阶段用完才生成下一阶段的走法，每次只选出剩余走法中分数最高的一个，
+// 在置换表走法或第一个吃子处就截断的节点不必生成和排序其余走法。
+// 吃子在被选出时才计算静态交换（SEE），亏子的吃子推迟到最后。
+// 给出的走法都是伪合法的，是否送将由搜索在走子后检查。
+class MovePicker
+{
+public:
+    MovePicker(const Position &position, const MoveOrderer *orderer, int ply,
+               const std::optional<AIMove> &ttMove);
+
+    // 取下一个走法，没有更多走法时返回 false
+    bool next(AIMove &move);
+
+private:
+    enum class Stage {
+        TTMove,
+        GenerateCaptures,
+        Captures,
+        Killers,
+        GenerateQuiets,
+        Quiets,
+        BadCaptures,
+        Done
+    };
+
+    // 生成当前阶段的走法并打分（跳过已经给出的置换表/杀手走法）
+    void generate(MoveGenType type);
+
+    // 从剩余走法中选出分数最高的一个（部分选择排序）
+    AIMove pickBest();
+
+    const Position &m_position;
+    const MoveOrderer *m_orderer;
+    PieceColor m_color;
+    Stage m_stage;
+
+    AIMove m_ttMove;       // 已验证的置换表走法（无效表示没有）
+    AIMove m_killers[2];   // 本层杀手走法
+    int m_killerIndex;
+
+    MoveList m_moves;      // 当前阶段的走法
+    int m_index;           // 下一个待选走法的位置
+
+    MoveList m_badCaptures;  // 静态交换为负、推迟给出的吃子
+    int m_badIndex;
+};
+
+#endif // MOVEPICKER_H
@@ -1,12 +1,12 @@
 #include "OpeningBook.h"
 #include "../core/Board.h"
+#include "../core/ChessRules.h"
 #include <QRandomGenerator>
 #include <QDebug>
 #include <QtMath>
 
-OpeningBook::OpeningBook(TranspositionTable *tt)
+OpeningBook::OpeningBook()
     : m_enabled(true)
-    , m_transpositionTable(tt)
 {
     initializeCommonOpenings();
 }
@@ -100,132 +100,135 @@ void OpeningBook::initializeCommonOpenings()
 
     // 创建初始局面
     Position initialPos;
-    quint64 initKey = m_transpositionTable->computeZobristKey(initialPos);
+    UndoInfo undo;
+    quint64 initKey = initialPos.zobristKey();
 
     // ========== 红方第一步（红先） ==========
 
     // 1. 中炮开局 - 炮二平五（最流行）
-    addSymmetricMoves(initialPos, AIMove(2, 1, 2, 4), 100, 54); // 炮二平五
+    addSymmetricMoves(initialPos, AIMove(7, 7, 7, 4), 100, 54); // 炮二平五
 
     // 2. 起马局 - 马二进三 / 马八进七
-    addSymmetricMoves(initialPos, AIMove(0, 1, 2, 2), 90, 52);  // 马二进三
-    addSymmetricMoves(initialPos, AIMove(0, 7, 2, 6), 90, 52);  // 马八进七
+    addSymmetricMoves(initialPos, AIMove(9, 7, 7, 6), 90, 52);  // 马二进三
+    addSymmetricMoves(initialPos, AIMove(9, 1, 7, 2), 90, 52);  // 马八进七
 
     // 3. 仙人指路 - 兵三进一 / 兵七进一
-    addSymmetricMoves(initialPos, AIMove(3, 2, 4, 2), 85, 51);  // 兵三进一
+    addSymmetricMoves(initialPos, AIMove(6, 6, 5, 6), 85, 51);  // 兵三进一
 
     // 4. 飞相局 - 相三进五 / 相七进五
-    addSymmetricMoves(initialPos, AIMove(0, 2, 2, 4), 70, 50);  // 相三进五
+    addSymmetricMoves(initialPos, AIMove(9, 6, 7, 4), 70, 50);  // 相三进五
 
     // 5. 过宫炮 - 炮二平六
-    addMove(initKey, AIMove(2, 1, 2, 5), 60, 50);  // 炮二平六
-    addMove(initKey, AIMove(2, 7, 2, 3), 60, 50);  // 炮八平四（镜像）
+    addMove(initKey, AIMove(7, 7, 7, 3), 60, 50);  // 炮二平六
+    addMove(initKey, AIMove(7, 1, 7, 5), 60, 50);  // 炮八平四（镜像）
 
     // 6. 士角炮
-    addMove(initKey, AIMove(2, 1, 2, 3), 55, 49);  // 炮二平四
-    addMove(initKey, AIMove(2, 7, 2, 5), 55, 49);  // 炮八平六（镜像）
+    addMove(initKey, AIMove(7, 7, 7, 5), 55, 49);  // 炮二平四
+    addMove(initKey, AIMove(7, 1, 7, 3), 55, 49);  // 炮八平六（镜像）
 
     // ========== 应对中炮（炮二平五后的局面） ==========
 
     Position afterCenterCannon = initialPos;
-    afterCenterCannon.board().movePiece(2, 1, 2, 4);
-    afterCenterCannon.switchTurn();
-    quint64 afterCenterCannonKey = m_transpositionTable->computeZobristKey(afterCenterCannon);
+    afterCenterCannon.makeMove(AIMove(7, 7, 7, 4), undo);
+    quint64 afterCenterCannonKey = afterCenterCannon.zobristKey();
 
     // 黑方应对中炮：
     // 1. 屏风马 - 马8进7（最常见）
-    addSymmetricMoves(afterCenterCannon, AIMove(9, 7, 7, 6), 100, 53); // 马8进7
+    addSymmetricMoves(afterCenterCannon, AIMove(0, 7, 2, 6), 100, 53); // 马8进7
 
     // 2. 反攻中炮 - 炮8平5
-    addSymmetricMoves(afterCenterCannon, AIMove(7, 7, 7, 4), 95, 52);  // 炮8平5
+    addSymmetricMoves(afterCenterCannon, AIMove(2, 7, 2, 4), 95, 52);  // 炮8平5
 
     // 3. 飞象局 - 象7进5
-    addSymmetricMoves(afterCenterCannon, AIMove(9, 6, 7, 4), 80, 50);  // 象7进5
+    addSymmetricMoves(afterCenterCannon, AIMove(0, 6, 2, 4), 80, 50);  // 象7进5
 
     // 4. 进卒 - 卒7进1
-    addSymmetricMoves(afterCenterCannon, AIMove(6, 6, 5, 6), 75, 50);  // 卒7进1
+    addSymmetricMoves(afterCenterCannon, AIMove(3, 6, 4, 6), 75, 50);  // 卒7进1
 
     // ========== 应对起马（马二进三后的局面） ==========
 
     Position afterHorseMove = initialPos;
-    afterHorseMove.board().movePiece(0, 1, 2, 2);
-    afterHorseMove.switchTurn();
-    quint64 afterHorseMoveKey = m_transpositionTable->computeZobristKey(afterHorseMove);
+    afterHorseMove.makeMove(AIMove(9, 7, 7, 6), undo);
+    quint64 afterHorseMoveKey = afterHorseMove.zobristKey();
 
     // 黑方应对：
     // 1. 对跳马 - 马8进7
-    addSymmetricMoves(afterHorseMove, AIMove(9, 7, 7, 6), 100, 52);  // 马8进7
+    addSymmetricMoves(afterHorseMove, AIMove(0, 7, 2, 6), 100, 52);  // 马8进7
 
     // 2. 飞象 - 象7进5
-    addSymmetricMoves(afterHorseMove, AIMove(9, 6, 7, 4), 90, 51);   // 象7进5
+    addSymmetricMoves(afterHorseMove, AIMove(0, 6, 2, 4), 90, 51);   // 象7进5
 
     // 3. 出炮 - 炮8平6
-    addMove(afterHorseMoveKey, AIMove(7, 7, 7, 5), 85, 50);  // 炮8平6
-    addMove(afterHorseMoveKey, AIMove(7, 1, 7, 3), 85, 50);  // 炮2平4（镜像）
+    addMove(afterHorseMoveKey, AIMove(2, 7, 2, 5), 85, 50);  // 炮8平6
+    addMove(afterHorseMoveKey, AIMove(2, 1, 2, 3), 85, 50);  // 炮2平4（镜像）
 
     // ========== 应对起马（马八进七后的局面） ==========
 
     Position afterHorseMove2 = initialPos;
-    afterHorseMove2.board().movePiece(0, 7, 2, 6);
-    afterHorseMove2.switchTurn();
-    quint64 afterHorseMove2Key = m_transpositionTable->computeZobristKey(afterHorseMove2);
+    afterHorseMove2.makeMove(AIMove(9, 1, 7, 2), undo);
+    quint64 afterHorseMove2Key = afterHorseMove2.zobristKey();
 
     // 黑方应对：
     // 1. 对跳马 - 马2进3
-    addSymmetricMoves(afterHorseMove2, AIMove(9, 1, 7, 2), 100, 52);  // 马2进3
+    addSymmetricMoves(afterHorseMove2, AIMove(0, 1, 2, 2), 100, 52);  // 马2进3
 
     // 2. 飞象 - 象3进5
-    addSymmetricMoves(afterHorseMove2, AIMove(9, 2, 7, 4), 90, 51);   // 象3进5
+    addSymmetricMoves(afterHorseMove2, AIMove(0, 2, 2, 4), 90, 51);   // 象3进5
 
     // 3. 出炮 - 炮2平4
-    addMove(afterHorseMove2Key, AIMove(7, 1, 7, 3), 85, 50);  // 炮2平4
-    addMove(afterHorseMove2Key, AIMove(7, 7, 7, 5), 85, 50);  // 炮8平6（镜像）
+    addMove(afterHorseMove2Key, AIMove(2, 1, 2, 3), 85, 50);  // 炮2平4
+    addMove(afterHorseMove2Key, AIMove(2, 7, 2, 5), 85, 50);  // 炮8平6（镜像）
 
     // ========== 应对仙人指路（兵三进一后的局面） ==========
 
     Position afterPawnMove = initialPos;
-    afterPawnMove.board().movePiece(3, 2, 4, 2);
-    afterPawnMove.switchTurn();
-    quint64 afterPawnMoveKey = m_transpositionTable->computeZobristKey(afterPawnMove);
+    afterPawnMove.makeMove(AIMove(6, 6, 5, 6), undo);
+    quint64 afterPawnMoveKey = afterPawnMove.zobristKey();
 
     // 黑方应对：
     // 1. 对进卒 - 卒7进1
-    addSymmetricMoves(afterPawnMove, AIMove(6, 6, 5, 6), 100, 51);  // 卒7进1
+    addSymmetricMoves(afterPawnMove, AIMove(3, 6, 4, 6), 100, 51);  // 卒7进1
 
     // 2. 飞象 - 象7进5
-    addSymmetricMoves(afterPawnMove, AIMove(9, 6, 7, 4), 90, 50);   // 象7进5
+    addSymmetricMoves(afterPawnMove, AIMove(0, 6, 2, 4), 90, 50);   // 象7进5
 
     // 3. 起马 - 马8进7
-    addSymmetricMoves(afterPawnMove, AIMove(9, 7, 7, 6), 85, 50);   // 马8进7
+    addSymmetricMoves(afterPawnMove, AIMove(0, 7, 2, 6), 85, 50);   // 马8进7
 
     // ========== 中炮对屏风马（经典对局） ==========
 
     Position centerCannonVsScreen = afterCenterCannon;
-    centerCannonVsScreen.board().movePiece(9, 7, 7, 6);
-    centerCannonVsScreen.switchTurn();
-    quint64 centerCannonVsScreenKey = m_transpositionTable->computeZobristKey(centerCannonVsScreen);
+    centerCannonVsScreen.makeMove(AIMove(0, 7, 2, 6), undo);
+    quint64 centerCannonVsScreenKey = centerCannonVsScreen.zobristKey();
 
     // 红方继续：
     // 1. 马二进三（标准）
-    addSymmetricMoves(centerCannonVsScreen, AIMove(0, 1, 2, 2), 100, 54);  // 马二进三
+    addSymmetricMoves(centerCannonVsScreen, AIMove(9, 7, 7, 6), 100, 54);  // 马二进三
 
     // 2. 兵三进一（兵炮配合）
-    addSymmetricMoves(centerCannonVsScreen, AIMove(3, 2, 4, 2), 90, 52);   // 兵三进一
+    addSymmetricMoves(centerCannonVsScreen, AIMove(6, 6, 5, 6), 90, 52);   // 兵三进一
 
-    // 3. 车一平二（快速出车）
-    addSymmetricMoves(centerCannonVsScreen, AIMove(0, 0, 0, 1), 85, 51);   // 车一平二
-
-    // 4. 兵七进一
-    addSymmetricMoves(centerCannonVsScreen, AIMove(3, 6, 4, 6), 80, 50);   // 兵七进一
+    // 3. 兵七进一
+    addSymmetricMoves(centerCannonVsScreen, AIMove(6, 2, 5, 2), 80, 50);   // 兵七进一
 
     qDebug() << "开局库初始化完成："
              << m_book.size() << "个局面";
+
+    // 键值包含走棋方，走法方向弄反时开局库永远不会命中
+    if (!m_book.contains(initKey)) {
+        qWarning() << "[开局库] 初始局面没有开局走法";
+    }
 }
 
 void OpeningBook::addSymmetricMoves(const Position &pos, const AIMove &move, int weight, int winRate)
 {
-    // 1. 添加原始移动
-    quint64 key = m_transpositionTable->computeZobristKey(pos);
+    // 1. 添加原始移动（必须是当前走棋方的合法走法，否则按该局面键值永远不会用到）
+    if (!isPlayable(pos, move)) {
+        qWarning() << "[开局库] 忽略不合法的走法:" << move.fromRow << move.fromCol
+                   << "->" << move.toRow << move.toCol;
+        return;
+    }
+    quint64 key = pos.zobristKey();
     addMove(key, move, weight, winRate);
 
     // 2. 中国象棋左右对称，添加镜像移动
@@ -238,8 +241,8 @@ void OpeningBook::addSymmetricMoves(const Position &pos, const AIMove &move, int
     // 遍历原始局面的所有棋子，创建镜像局面
     for (int row = 0; row < Board::ROWS; ++row) {
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = pos.board().pieceAt(row, col);
-            if (piece && piece->isValid()) {
+            quint8 piece = pos.board().pieceCode(row, col);
+            if (piece != Board::EMPTY) {
                 // 在镜像位置放置相同的棋子
                 int mirrorCol = 8 - col;
                 // 注意：我们需要复制棋子，但 Board 类可能不支持直接设置棋子
@@ -256,10 +259,18 @@ void OpeningBook::addSymmetricMoves(const Position &pos, const AIMove &move, int
         Position tempMirrorPos = pos;
 
         // 检查镜像移动是否合法
-        const ChessPiece *mirrorPiece = tempMirrorPos.board().pieceAt(mirrorMove.fromRow, mirrorMove.fromCol);
-        if (mirrorPiece && mirrorPiece->isValid()) {
-            quint64 mirrorKey = m_transpositionTable->computeZobristKey(tempMirrorPos);
+        if (isPlayable(tempMirrorPos, mirrorMove)) {
+            quint64 mirrorKey = tempMirrorPos.zobristKey();
             addMove(mirrorKey, mirrorMove, weight, winRate);
         }
     }
 }
+
+bool OpeningBook::isPlayable(const Position &pos, const AIMove &move)
+{
+    if (!ChessRules::isPseudoLegal(pos.board(), pos.currentTurn(), move)) {
+        return false;
+    }
+    Board board = pos.board();
+    return !ChessRules::wouldBeInCheck(board, move.fromRow, move.fromCol, move.toRow, move.toCol);
+}
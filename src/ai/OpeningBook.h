@@ -1,8 +1,8 @@
 #ifndef OPENINGBOOK_H
 #define OPENINGBOOK_H
 
-#include "TranspositionTable.h"
 #include "../core/Position.h"
+#include "../core/Move.h"
 #include <QHash>
 #include <QList>
 
@@ -21,7 +21,7 @@ struct BookEntry {
 class OpeningBook
 {
 public:
-    OpeningBook(TranspositionTable *tt);
+    OpeningBook();
 
     // 选择最佳开局走法（根据权重随机选择）
     AIMove selectMove(quint64 zobristKey);
@@ -40,10 +40,12 @@ private:
     // 开局库：zobrist_key -> 可能的走法列表
     QHash<quint64, QList<BookEntry>> m_book;
     bool m_enabled;
-    TranspositionTable *m_transpositionTable;
 
     // 辅助函数：添加对称位置
     void addSymmetricMoves(const Position &pos, const AIMove &move, int weight, int winRate);
+
+    // 辅助函数：走法是否为该局面走棋方的合法走法
+    static bool isPlayable(const Position &pos, const AIMove &move);
 };
 
 #endif // OPENINGBOOK_H
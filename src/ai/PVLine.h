@@ -0,0 +1,19 @@
+#ifndef PVLINE_H
+#define PVLINE_H
+
+#include "../core/Move.h"
+#include <QList>
+
+// 一条主要变例（PV）
+//
+// 从根局面开始的预期着法序列及其分数，MultiPV 分析时每个候选根走法各有一条。
+struct PVLine {
+    int score = 0;          // 根局面走子方视角的分数
+    int depth = 0;          // 得到这条变例的迭代深度
+    QList<AIMove> moves;    // 着法序列（第一个为根走法）
+
+    bool isEmpty() const { return moves.isEmpty(); }
+    AIMove firstMove() const { return moves.isEmpty() ? AIMove() : moves.first(); }
+};
+
+#endif // PVLINE_H
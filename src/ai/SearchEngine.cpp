@@ -1,20 +1,35 @@
 #include "SearchEngine.h"
 #include <algorithm>
+#include <memory>
+#include <vector>
 #include <QDebug>
+#include <QThreadPool>
 
-SearchEngine::SearchEngine(TranspositionTable *tt, Evaluator *evaluator, MoveOrderer *orderer)
+SearchEngine::SearchEngine(TranspositionTable *tt, Evaluator *evaluator, MoveOrderer *orderer,
+                           EvalCache *evalCache)
     : m_transpositionTable(tt)
     , m_evaluator(evaluator)
     , m_moveOrderer(orderer)
+    , m_evalCache(evalCache)
     , m_nodesSearched(0)
     , m_pruneCount(0)
     , m_qsNodes(0)
     , m_nullMoveCuts(0)
     , m_lmrReductions(0)
+    , m_singularExtensions(0)
+    , m_evalCacheProbes(0)
+    , m_evalCacheHits(0)
     , m_currentDepth(0)
     , m_useIterativeDeepening(true)
     , m_useParallelSearch(true)
     , m_threadCount(0)  // 0表示自动检测
+    , m_evalCacheShared(true)
+    , m_stopped(false)
+    , m_isHelper(false)
+    , m_depthOffset(0)
+    , m_softLimitMs(0)
+    , m_hardLimitMs(0)
+    , m_checkCountdown(CHECK_INTERVAL)
 {
 }
 
@@ -25,80 +40,187 @@ void SearchEngine::resetStatistics()
     m_qsNodes = 0;
     m_nullMoveCuts = 0;
     m_lmrReductions = 0;
+    m_singularExtensions = 0;
+    m_evalCacheProbes = 0;
+    m_evalCacheHits = 0;
     m_currentDepth = 0;
 }
 
+void SearchEngine::addStatistics(const SearchEngine &other)
+{
+    m_nodesSearched += other.m_nodesSearched;
+    m_pruneCount += other.m_pruneCount;
+    m_qsNodes += other.m_qsNodes;
+    m_nullMoveCuts += other.m_nullMoveCuts;
+    m_lmrReductions += other.m_lmrReductions;
+    m_singularExtensions += other.m_singularExtensions;
+    m_evalCacheProbes += other.m_evalCacheProbes;
+    m_evalCacheHits += other.m_evalCacheHits;
+}
+
+void SearchEngine::startSearch(const SearchLimits &limits)
+{
+    m_stopped.store(false, std::memory_order_relaxed);
+    m_limits = limits;
+    m_timer.start();
+    m_softLimitMs = 0;
+    m_hardLimitMs = 0;
+    m_checkCountdown = CHECK_INTERVAL;
+
+    if (limits.moveTimeMs > 0) {
+        // 固定用时：用满为止，到时返回最后一轮完整迭代的结果
+        m_softLimitMs = m_hardLimitMs = std::max<qint64>(1, limits.moveTimeMs - MOVE_OVERHEAD_MS);
+    } else if (limits.remainingMs > 0) {
+        // 对局时钟：剩余时间按步数平分并加上大部分加秒作为计划用时，
+        // 复杂局面最多可用到计划的4倍，但不超过剩余时间
+        int movesToGo = limits.movesToGo > 0 ? limits.movesToGo : 30;
+        qint64 available = std::max<qint64>(1, limits.remainingMs - MOVE_OVERHEAD_MS);
+        qint64 planned = available / movesToGo + limits.incrementMs * 3 / 4;
+        m_hardLimitMs = std::max<qint64>(1, std::min(planned * 4, available));
+        m_softLimitMs = std::min(planned, m_hardLimitMs);
+    }
+}
+
+void SearchEngine::checkLimits()
+{
+    m_checkCountdown = CHECK_INTERVAL;
+
+    if (m_hardLimitMs > 0 && m_timer.elapsed() >= m_hardLimitMs) {
+        stop();
+    }
+    if (m_limits.nodes > 0 && m_nodesSearched + m_qsNodes >= m_limits.nodes) {
+        stop();
+    }
+    if (m_limits.stopFlag && m_limits.stopFlag->load(std::memory_order_relaxed)) {
+        stop();
+    }
+}
+
 // 迭代加深搜索
-AIMove SearchEngine::iterativeDeepening(Position &position, int maxDepth, bool isMaximizing, AIMove *bestMoveOut)
+//
+// MultiPV：每轮迭代先搜出最佳走法，再在其余根走法中搜出次佳走法，依此类推，
+// 每条变例各自以上一轮的分数为中心使用渴望窗口。找到的走法依次换到根走法列表前面，
+// 下一轮迭代按上一轮的名次先搜。
+AIMove SearchEngine::iterativeDeepening(Position &position, const SearchLimits &limits, AIMove *bestMoveOut)
 {
     AIMove bestMove;
-    int bestScore = isMaximizing ? -INF : INF;
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_SEARCH_DEPTH) : MAX_SEARCH_DEPTH;
 
-    qDebug() << "=== 迭代加深搜索开始 ===";
+    // 辅助线程由 parallelSearch 新建并由主线程停止，不在这里清除停止标志
+    if (!m_isHelper) {
+        startSearch(limits);
+        qDebug() << "=== 迭代加深搜索开始 ===";
+    }
+    m_pvLines.clear();
 
-    // 从深度1开始逐步加深
-    for (int depth = 1; depth <= maxDepth; ++depth) {
-        m_currentDepth = depth;
-        qDebug() << "搜索深度" << depth << "...";
+    // 生成所有可能的移动，使用上一次搜索的最佳移动进行排序
+    PieceColor currentColor = position.currentTurn();
+    quint64 posKey = position.zobristKey();
+    MoveList moves;
+    generateAllMoves(position, currentColor, moves);
 
-        // 生成所有可能的移动
-        PieceColor currentColor = position.currentTurn();
-        QList<AIMove> moves = generateAllMoves(position, currentColor);
+    if (moves.isEmpty()) {
+        if (bestMoveOut) *bestMoveOut = bestMove;
+        return bestMove;
+    }
 
-        if (moves.isEmpty()) {
-            break;
-        }
+    std::optional<AIMove> ttMove = m_transpositionTable->getBestMove(posKey);
+    m_moveOrderer->sortMoves(moves, position, 0, ttMove);
 
-        // 使用上一层的最佳移动进行排序
-        quint64 posKey = m_transpositionTable->computeZobristKey(position);
-        std::optional<AIMove> ttMove = m_transpositionTable->getBestMove(posKey);
-        m_moveOrderer->sortMoves(moves, position, 0, ttMove);
+    const int multiPV = std::clamp(limits.multiPV, 1, static_cast<int>(moves.size()));
+    QList<PVLine> lines;  // 本轮迭代已完成的变例
 
-        AIMove currentBestMove;
-        int currentBestScore = isMaximizing ? -INF : INF;
+    // 从深度1开始逐步加深（辅助线程整体加深 m_depthOffset 层）
+    for (int depth = 1 + m_depthOffset; depth <= maxDepth + m_depthOffset; ++depth) {
+        if (!m_isHelper) {
+            m_currentDepth = depth;
+            qDebug() << "搜索深度" << depth << "...";
+        }
 
-        for (int i = 0; i < moves.size(); ++i) {
-            AIMove &move = moves[i];
+        lines.clear();
+        for (int pvIndex = 0; pvIndex < multiPV; ++pvIndex) {
+            // 渴望窗口：以上一轮这条变例的分数为中心搜索，超出窗口时按指数扩大重搜
+            int alpha = -INF;
+            int beta = INF;
+            int delta = ASPIRATION_WINDOW;
+            if (depth >= ASPIRATION_MIN_DEPTH && pvIndex < m_pvLines.size()
+                && std::abs(m_pvLines[pvIndex].score) < MATE_BOUND) {
+                alpha = m_pvLines[pvIndex].score - delta;
+                beta = m_pvLines[pvIndex].score + delta;
+            }
 
-            Position tempPos = position;
-            tempPos.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-            tempPos.switchTurn();
+            AIMove currentBestMove;
+            int currentBestScore;
+            while (true) {
+                currentBestScore = searchRoot(position, moves, pvIndex, depth, alpha, beta, currentBestMove);
+                if (isStopped()) break;
+
+                // 本次找到的最佳走法换到本条变例的位置，重搜时先搜它
+                for (int i = pvIndex; i < moves.size(); ++i) {
+                    if (moves[i] == currentBestMove) {
+                        std::rotate(moves.begin() + pvIndex, moves.begin() + i, moves.begin() + i + 1);
+                        break;
+                    }
+                }
 
-            int score;
-            if (i == 0) {
-                score = pvs(tempPos, depth - 1, -INF, INF, !isMaximizing, true, depth);
-            } else {
-                score = pvs(tempPos, depth - 1,
-                           isMaximizing ? currentBestScore : -INF,
-                           isMaximizing ? INF : currentBestScore,
-                           !isMaximizing, false, depth);
+                if (currentBestScore <= alpha) {
+                    // 低出：真实分数不高于 currentBestScore，向下扩大窗口
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(currentBestScore - delta, -INF);
+                } else if (currentBestScore >= beta) {
+                    // 高出：真实分数不低于 currentBestScore，向上扩大窗口
+                    beta = std::min(currentBestScore + delta, INF);
+                } else {
+                    break;
+                }
+                delta *= 2;
             }
 
-            if (isMaximizing) {
-                if (score > currentBestScore) {
-                    currentBestScore = score;
-                    currentBestMove = move;
+            // 被停止的迭代不完整：最佳走法只有已证明好于窗口下沿才采用，否则保留上一轮的结果
+            if (isStopped()) {
+                if (pvIndex == 0 && currentBestMove.isValid() && currentBestScore > alpha) {
+                    bestMove = currentBestMove;
+                    bestMove.score = currentBestScore;
                 }
-            } else {
-                if (score < currentBestScore) {
-                    currentBestScore = score;
-                    currentBestMove = move;
+                break;
+            }
+
+            lines.append(rootPV(currentBestMove, currentBestScore, depth));
+        }
+
+        if (isStopped()) {
+            if (!bestMove.isValid()) {
+                bestMove = moves[0];
+            }
+            break;
+        }
+
+        // 本轮完整：更新最佳移动与各条变例
+        m_pvLines = lines;
+        bestMove = lines.first().firstMove();
+        bestMove.score = lines.first().score;
+
+        if (!m_isHelper) {
+            for (int i = 0; i < m_pvLines.size(); ++i) {
+                QStringList pv;
+                for (const AIMove &move : m_pvLines[i].moves) {
+                    pv << QString("%1%2-%3%4").arg(move.fromRow).arg(move.fromCol).arg(move.toRow).arg(move.toCol);
                 }
+                qDebug() << "深度" << depth << "变例" << i + 1 << "评分:" << m_pvLines[i].score
+                         << "PV:" << pv.join(" ");
             }
         }
 
-        // 更新最佳移动
-        if (currentBestMove.isValid()) {
-            bestMove = currentBestMove;
-            bestScore = currentBestScore;
+        // 存储到置换表
+        m_transpositionTable->store(posKey, depth, scoreToTT(bestMove.score, 0), TTEntry::EXACT, bestMove);
 
-            qDebug() << "深度" << depth << "最佳移动:"
-                     << bestMove.fromRow << bestMove.fromCol << "->"
-                     << bestMove.toRow << bestMove.toCol
-                     << "评分:" << bestScore;
+        if (!m_isHelper && m_progressCallback) {
+            m_progressCallback(depth, m_nodesSearched);
+        }
 
-            // 存储到置换表
-            m_transpositionTable->store(posKey, depth, bestScore, TTEntry::EXACT, bestMove);
+        // 超过软时限：下一轮迭代大概率来不及完成，不再开始
+        if (m_softLimitMs > 0 && m_timer.elapsed() >= m_softLimitMs) {
+            break;
         }
     }
 
@@ -106,233 +228,437 @@ AIMove SearchEngine::iterativeDeepening(Position &position, int maxDepth, bool i
         *bestMoveOut = bestMove;
     }
 
-    qDebug() << "=== 迭代加深搜索完成 ===";
+    if (!m_isHelper) qDebug() << "=== 迭代加深搜索完成 ===";
     return bestMove;
 }
 
-int SearchEngine::pvs(Position &position, int depth, int alpha, int beta, bool isMaximizing, bool isPV, int maxDepth)
+// 根节点搜索
+//
+// 在 [alpha, beta] 窗口内依次搜索根走法：第一个走法用完整窗口，其余先用零窗口试探，
+// 好于当前最佳时再用完整窗口重搜。返回软边界分数（可能落在窗口外），best 为最佳走法。
+int SearchEngine::searchRoot(Position &position, const MoveList &moves, int first, int depth, int alpha, int beta, AIMove &best)
 {
-    m_nodesSearched++;
+    int bestScore = -INF;
+    best = AIMove();
+    m_pvLength[0] = 0;
 
-    // 检查置换表
-    quint64 posKey = m_transpositionTable->computeZobristKey(position);
-    int ttScore;
-    if (m_transpositionTable->probe(posKey, depth, alpha, beta, ttScore)) {
-        return ttScore;
+    for (int i = first; i < moves.size(); ++i) {
+        const AIMove &move = moves[i];
+
+        UndoInfo undo;
+        position.makeMove(move, undo);
+
+        int score;
+        if (i == first) {
+            score = -pvs(position, depth - 1, -beta, -alpha, 1, true);
+        } else {
+            score = -pvs(position, depth - 1, -alpha - 1, -alpha, 1, false);
+            if (score > alpha && score < beta) {
+                score = -pvs(position, depth - 1, -beta, -alpha, 1, true);
+            }
+        }
+
+        position.unmakeMove(move, undo);
+
+        if (isStopped()) break;
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = move;
+        }
+        if (score > alpha) {
+            alpha = score;
+            updatePV(0, move);
+        }
+
+        // 超出窗口：由调用方扩大窗口后重搜
+        if (alpha >= beta) break;
     }
 
-    PieceColor currentColor = position.currentTurn();
+    return bestScore;
+}
 
-    // 检查游戏结束状态
-    if (ChessRules::isCheckmate(position.board(), currentColor)) {
-        int score = isMaximizing ? -MATE_SCORE + (maxDepth - depth) : MATE_SCORE - (maxDepth - depth);
-        m_transpositionTable->store(posKey, depth, score, TTEntry::EXACT, AIMove());
-        return score;
+void SearchEngine::updatePV(int ply, const AIMove &move)
+{
+    m_pvTable[ply][ply] = move;
+    for (int i = ply + 1; i < m_pvLength[ply + 1]; ++i) {
+        m_pvTable[ply][i] = m_pvTable[ply + 1][i];
     }
+    m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+}
+
+PVLine SearchEngine::rootPV(const AIMove &best, int score, int depth) const
+{
+    PVLine line;
+    line.score = score;
+    line.depth = depth;
+
+    // 根节点的变例在最佳走法提高 alpha 时写入，最佳走法低出时变例为空或属于其他走法
+    if (m_pvLength[0] > 0 && m_pvTable[0][0] == best) {
+        for (int i = 0; i < m_pvLength[0]; ++i) {
+            AIMove move(m_pvTable[0][i].fromRow, m_pvTable[0][i].fromCol,
+                        m_pvTable[0][i].toRow, m_pvTable[0][i].toCol);
+            line.moves.append(move);
+        }
+    } else {
+        line.moves.append(AIMove(best.fromRow, best.fromCol, best.toRow, best.toCol));
+    }
+    return line;
+}
+
+int SearchEngine::pvs(Position &position, int depth, int alpha, int beta, int ply, bool isPV)
+{
+    m_nodesSearched++;
+    m_pvLength[ply] = ply;
 
-    if (ChessRules::isStalemate(position.board(), currentColor)) {
-        m_transpositionTable->store(posKey, depth, 0, TTEntry::EXACT, AIMove());
+    if (--m_checkCountdown <= 0) {
+        checkLimits();
+    }
+
+    // 搜索已被停止：直接返回，调用方会丢弃这个结果
+    if (isStopped()) {
         return 0;
     }
 
+    // 超出变例数组的层数（只在极长的将军序列中出现）：直接返回静态评估
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(position, ChessRules::isInCheck(position.board(), position.currentTurn()));
+    }
+
+    // 重复局面：按长将、长捉规则直接裁决，不再展开
+    // （裁决结果与到达路径有关，不写入置换表）
+    if (ply > 0) {
+        switch (ChessRules::judgeRepetition(position)) {
+        case RepetitionResult::None:
+            break;
+        case RepetitionResult::Draw:
+            return 0;
+        case RepetitionResult::Win:
+            return BAN_SCORE;
+        case RepetitionResult::Loss:
+            return -BAN_SCORE;
+        }
+    }
+
+    // 将死距离剪枝：本层能得到的最好结果是下一步将死对方，最坏是本层被将死，
+    // 窗口落在这个范围之外时不必再搜（已找到更短的杀法）
+    if (ply > 0) {
+        alpha = std::max(alpha, -MATE_SCORE + ply);
+        beta = std::min(beta, MATE_SCORE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
+    // 排除走法（奇异扩展的验证搜索）：结果与完整搜索不同，不查置换表截断，也不写入
+    const AIMove excludedMove = m_excludedMoves[ply];
+    const bool excluding = excludedMove.isValid();
+
+    // 检查置换表：深度足够且边界类型允许时直接返回（PV 节点不截断，保证变例完整），
+    // 否则只取其中的走法用于排序
+    quint64 posKey = position.zobristKey();
+    TTEntry ttEntry;
+    bool ttHit = !excluding && m_transpositionTable->probe(posKey, ttEntry);
+    int ttScore = ttHit ? scoreFromTT(ttEntry.score, ply) : 0;
+    std::optional<AIMove> ttMove;
+    if (ttHit) {
+        if (!isPV && ttEntry.depth >= depth
+            && (ttEntry.flag == TTEntry::EXACT
+                || (ttEntry.flag == TTEntry::LOWER_BOUND && ttScore >= beta)
+                || (ttEntry.flag == TTEntry::UPPER_BOUND && ttScore <= alpha))) {
+            return ttScore;
+        }
+        if (ttEntry.bestMove.isValid()) {
+            ttMove = ttEntry.bestMove;
+        }
+    }
+
+    PieceColor currentColor = position.currentTurn();
+    bool inCheck = ChessRules::isInCheck(position.board(), currentColor);
+
+    // 将军延伸：被将军的节点多搜一层，连续将军的杀法不会在水平线处被截断。
+    // 被将军时也就不会直接进入只看吃子的静态搜索
+    if (inCheck && ply < MAX_PLY / 2) {
+        ++depth;
+    }
+
     // 叶子节点：进入静态搜索
     if (depth <= 0) {
-        int score = quiescence(position, alpha, beta, isMaximizing);
-        m_transpositionTable->store(posKey, 0, score, TTEntry::EXACT, AIMove());
+        // 静态搜索在窗口外返回的是边界值，不能当作精确分数存入置换表
+        int score = quiescence(position, alpha, beta);
+        if (isStopped()) return 0;
+        TTEntry::Flag qsFlag = TTEntry::EXACT;
+        if (score <= alpha) {
+            qsFlag = TTEntry::UPPER_BOUND;
+        } else if (score >= beta) {
+            qsFlag = TTEntry::LOWER_BOUND;
+        }
+        m_transpositionTable->store(posKey, 0, score, qsFlag, AIMove());
         return score;
     }
 
+    // 浅层节点的静态评估（供反向前向剪枝和前向剪枝使用）
+    const bool shallow = !isPV && !inCheck && !excluding && depth <= Evaluator::MAX_PRUNING_DEPTH;
+    const int staticEval = shallow ? evaluate(position, false) : 0;
+
+    // 反向前向剪枝（静态空着）：局面好到减去边界仍不低于 beta，认为对方无法挽回
+    if (shallow && std::abs(beta) < MATE_BOUND
+        && staticEval - m_evaluator->reverseFutilityMargin(depth) >= beta) {
+        m_pruneCount++;
+        return staticEval;
+    }
+
+    // 前向剪枝：局面差到加上边界仍不超过 alpha，平静走法无望提高 alpha
+    const bool futile = shallow && std::abs(alpha) < MATE_BOUND
+        && staticEval + m_evaluator->futilityMargin(depth) <= alpha;
+    const int lateMoveCount = shallow ? m_evaluator->lateMoveCount(depth) : 0;
+    int quietMoves = 0;
+
     // 空移动剪枝（Null Move Pruning）
-    if (!isPV && depth >= 3 && !ChessRules::isInCheck(position.board(), currentColor)) {
-        int nullScore = nullMoveSearch(position, depth, beta, isMaximizing, maxDepth);
-        if ((isMaximizing && nullScore >= beta) || (!isMaximizing && nullScore <= alpha)) {
+    if (!isPV && !excluding && depth >= 3 && !inCheck) {
+        int nullScore = nullMoveSearch(position, depth, beta, ply);
+        if (isStopped()) return 0;
+        if (nullScore >= beta) {
             m_nullMoveCuts++;
-            return nullScore;
+            // 空着搜索得到的将死分数不可靠，只返回 beta
+            return nullScore >= MATE_BOUND ? beta : nullScore;
         }
     }
 
-    // 生成所有可能的移动
-    QList<AIMove> moves = generateAllMoves(position, currentColor);
-
-    if (moves.isEmpty()) {
-        m_transpositionTable->store(posKey, depth, 0, TTEntry::EXACT, AIMove());
-        return 0;
+    // 奇异扩展：置换表走法的下界明显好于其余所有走法时，它是唯一的好棋，多搜一层。
+    // 用降低深度、排除该走法的零窗口搜索验证其余走法都达不到 singularBeta
+    bool singular = false;
+    if (ply > 0 && !excluding && depth >= SINGULAR_MIN_DEPTH && ttMove.has_value()
+        && ttEntry.depth >= depth - 3 && ttEntry.flag != TTEntry::UPPER_BOUND
+        && std::abs(ttScore) < MATE_BOUND) {
+        int singularBeta = ttScore - SINGULAR_MARGIN * depth;
+        m_excludedMoves[ply] = *ttMove;
+        int score = pvs(position, (depth - 1) / 2, singularBeta - 1, singularBeta, ply, false);
+        m_excludedMoves[ply] = AIMove();
+        if (isStopped()) return 0;
+        m_pvLength[ply] = ply;
+
+        if (score < singularBeta) {
+            singular = true;
+            m_singularExtensions++;
+        }
     }
 
-    // 移动排序
-    std::optional<AIMove> ttMove = m_transpositionTable->getBestMove(posKey);
-    m_moveOrderer->sortMoves(moves, position, maxDepth - depth, ttMove);
+    // 分阶段取走法：置换表走法、吃子、杀手、其余走法（伪合法，送将在走子后检查）
+    MovePicker picker(position, m_moveOrderer, ply, ttMove);
+    AIMove move;
 
+    const int originalAlpha = alpha;
+    int bestScore = -INF;
     AIMove bestMove;
-    TTEntry::Flag flag = TTEntry::UPPER_BOUND;
-    bool isFirstMove = true;
+    int legalMoves = 0;
 
-    if (isMaximizing) {
-        int maxEval = -INF;
+    while (picker.next(move)) {
+        if (excluding && move == excludedMove) {
+            continue;
+        }
 
-        for (int i = 0; i < moves.size(); ++i) {
-            const AIMove &move = moves[i];
-            Position tempPos = position;
-            tempPos.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-            tempPos.switchTurn();
+        UndoInfo undo;
+        position.makeMove(move, undo);
 
-            int eval;
-            int newDepth = depth - 1;
+        // 走子后己方被将军：非法走法，跳过
+        if (ChessRules::isInCheck(position.board(), currentColor)) {
+            position.unmakeMove(move, undo);
+            continue;
+        }
+        ++legalMoves;
 
-            // Late Move Reduction (LMR)
-            if (!isPV && i >= 4 && depth >= 3 && !ChessRules::isInCheck(position.board(), currentColor)) {
-                newDepth = depth - 2;
-                m_lmrReductions++;
+        // 浅层的平静走法（不吃子、不将军）：前向剪枝与后期走法剪枝，至少保留一个走法
+        if (shallow && undo.captured == Board::EMPTY && legalMoves > 1) {
+            bool givesCheck = ChessRules::isInCheck(position.board(), position.currentTurn());
+            if (!givesCheck && (futile || quietMoves >= lateMoveCount)) {
+                position.unmakeMove(move, undo);
+                m_pruneCount++;
+                continue;
             }
+        }
+        if (undo.captured == Board::EMPTY) {
+            ++quietMoves;
+        }
 
-            if (isFirstMove) {
-                eval = pvs(tempPos, newDepth, alpha, beta, false, isPV, maxDepth);
-                isFirstMove = false;
-            } else {
-                eval = pvs(tempPos, newDepth, alpha, alpha + 1, false, false, maxDepth);
+        int newDepth = depth - 1;
+        if (singular && ttMove.has_value() && move == *ttMove) {
+            ++newDepth;
+        }
 
-                if (eval > alpha && eval < beta) {
-                    eval = pvs(tempPos, newDepth, alpha, beta, false, isPV, maxDepth);
-                }
-            }
+        // Late Move Reduction (LMR)：从第5个合法走法起少搜一层，将军的走法不减少（对方节点会得到将军延伸）
+        int reduction = 0;
+        if (!isPV && legalMoves > 4 && depth >= 3 && !inCheck
+            && !ChessRules::isInCheck(position.board(), position.currentTurn())) {
+            reduction = 1;
+            m_lmrReductions++;
+        }
 
-            if (eval > maxEval) {
-                maxEval = eval;
-                bestMove = move;
+        int score;
+        if (legalMoves == 1) {
+            score = -pvs(position, newDepth, -beta, -alpha, ply + 1, isPV);
+        } else {
+            score = -pvs(position, newDepth - reduction, -alpha - 1, -alpha, ply + 1, false);
+
+            // 减少深度的搜索高出：先按完整深度用零窗口验证，不能直接当作截断
+            if (reduction > 0 && score > alpha) {
+                score = -pvs(position, newDepth, -alpha - 1, -alpha, ply + 1, false);
             }
-            alpha = std::max(alpha, eval);
 
-            // Beta剪枝
-            if (beta <= alpha) {
-                m_pruneCount++;
-                m_moveOrderer->updateKillerMove(move, maxDepth - depth);
-                m_moveOrderer->updateHistory(move, depth);
-                flag = TTEntry::LOWER_BOUND;
-                break;
+            // PV 节点：零窗口高出后用完整窗口重搜
+            if (isPV && score > alpha && score < beta) {
+                score = -pvs(position, newDepth, -beta, -alpha, ply + 1, true);
             }
         }
 
-        if (maxEval > alpha) flag = TTEntry::EXACT;
-        m_transpositionTable->store(posKey, depth, maxEval, flag, bestMove);
-        return maxEval;
-    } else {
-        int minEval = INF;
-
-        for (int i = 0; i < moves.size(); ++i) {
-            const AIMove &move = moves[i];
-            Position tempPos = position;
-            tempPos.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-            tempPos.switchTurn();
+        position.unmakeMove(move, undo);
 
-            int eval;
-            int newDepth = depth - 1;
+        // 被停止时子树结果不可信，不写入置换表
+        if (isStopped()) return 0;
 
-            // Late Move Reduction (LMR)
-            if (!isPV && i >= 4 && depth >= 3 && !ChessRules::isInCheck(position.board(), currentColor)) {
-                newDepth = depth - 2;
-                m_lmrReductions++;
-            }
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        if (score > alpha) {
+            alpha = score;
+            if (isPV) updatePV(ply, move);
+        }
 
-            if (isFirstMove) {
-                eval = pvs(tempPos, newDepth, alpha, beta, true, isPV, maxDepth);
-                isFirstMove = false;
-            } else {
-                eval = pvs(tempPos, newDepth, beta - 1, beta, true, false, maxDepth);
+        // Beta剪枝
+        if (alpha >= beta) {
+            m_pruneCount++;
+            m_moveOrderer->updateKillerMove(move, ply);
+            m_moveOrderer->updateHistory(move, depth);
+            break;
+        }
+    }
 
-                if (eval > alpha && eval < beta) {
-                    eval = pvs(tempPos, newDepth, alpha, beta, true, isPV, maxDepth);
-                }
-            }
+    // 排除了唯一的走法：其余走法都不存在，按低出处理
+    if (excluding && legalMoves == 0) {
+        return alpha;
+    }
 
-            if (eval < minEval) {
-                minEval = eval;
-                bestMove = move;
-            }
-            beta = std::min(beta, eval);
+    // 没有合法走法：被将军为将死，否则为困毙（按和棋处理）
+    if (legalMoves == 0) {
+        int score = inCheck ? -MATE_SCORE + ply : 0;
+        m_transpositionTable->store(posKey, depth, scoreToTT(score, ply), TTEntry::EXACT, AIMove());
+        return score;
+    }
 
-            // Alpha剪枝
-            if (beta <= alpha) {
-                m_pruneCount++;
-                m_moveOrderer->updateKillerMove(move, maxDepth - depth);
-                m_moveOrderer->updateHistory(move, depth);
-                flag = TTEntry::LOWER_BOUND;
-                break;
-            }
-        }
+    if (excluding) {
+        return bestScore;
+    }
 
-        if (minEval < beta) flag = TTEntry::EXACT;
-        m_transpositionTable->store(posKey, depth, minEval, flag, bestMove);
-        return minEval;
+    // 边界类型按进入节点时的窗口判断：不高于原 alpha 为上界，达到 beta 为下界，否则为精确值
+    TTEntry::Flag flag = TTEntry::EXACT;
+    if (bestScore <= originalAlpha) {
+        flag = TTEntry::UPPER_BOUND;
+    } else if (bestScore >= beta) {
+        flag = TTEntry::LOWER_BOUND;
     }
+    m_transpositionTable->store(posKey, depth, scoreToTT(bestScore, ply), flag, bestMove);
+    return bestScore;
 }
 
-int SearchEngine::nullMoveSearch(Position &position, int depth, int beta, bool isMaximizing, int maxDepth)
+int SearchEngine::nullMoveSearch(Position &position, int depth, int beta, int ply)
 {
-    Position tempPos = position;
-    tempPos.switchTurn();
+    UndoInfo undo;
+    position.makeNullMove(undo);
 
     int R = 2;
-    int score = pvs(tempPos, depth - 1 - R, beta - 1, beta, !isMaximizing, false, maxDepth);
+    int score = -pvs(position, depth - 1 - R, -beta, -beta + 1, ply + 1, false);
+
+    position.unmakeNullMove(undo);
 
     return score;
 }
 
-int SearchEngine::quiescence(Position &position, int alpha, int beta, bool isMaximizing, int qsDepth)
+int SearchEngine::evaluate(const Position &position, bool inCheck)
+{
+    int score;
+    if (m_evalCache) {
+        ++m_evalCacheProbes;
+        if (m_evalCache->probe(position.zobristKey(), score)) {
+            ++m_evalCacheHits;
+        } else {
+            score = m_evaluator->evaluatePosition(position, inCheck);
+            m_evalCache->store(position.zobristKey(), score);
+        }
+    } else {
+        score = m_evaluator->evaluatePosition(position, inCheck);
+    }
+    return position.currentTurn() == PieceColor::Red ? score : -score;
+}
+
+int SearchEngine::scoreToTT(int score, int ply)
+{
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+int SearchEngine::scoreFromTT(int score, int ply)
+{
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+int SearchEngine::quiescence(Position &position, int alpha, int beta, int qsDepth)
 {
     m_qsNodes++;
 
-    // 限制静态搜索深度
-    if (qsDepth >= 4) {
-        return m_evaluator->evaluatePositionFast(position);
+    if (--m_checkCountdown <= 0) {
+        checkLimits();
+    }
+    if (isStopped()) {
+        return 0;
     }
 
     // 站立评估
-    int standPat = m_evaluator->evaluatePositionFast(position);
+    int standPat = evaluate(position, ChessRules::isInCheck(position.board(), position.currentTurn()));
 
-    if (isMaximizing) {
-        if (standPat >= beta) return beta;
-        if (standPat > alpha) alpha = standPat;
-    } else {
-        if (standPat <= alpha) return alpha;
-        if (standPat < beta) beta = standPat;
+    // 限制静态搜索深度
+    if (qsDepth >= 4) {
+        return standPat;
     }
 
+    // 软边界：截断时返回站立评估本身而不是窗口边界
+    if (standPat >= beta) return standPat;
+    if (standPat > alpha) alpha = standPat;
+
     // 只搜索吃子移动
     PieceColor currentColor = position.currentTurn();
-    QList<AIMove> captureMoves = generateCaptureMoves(position, currentColor);
+    MoveList captureMoves;
+    generateCaptureMoves(position, currentColor, captureMoves);
 
     if (captureMoves.isEmpty()) {
         return standPat;
     }
 
-    // Delta剪枝
-    if (!captureMoves.isEmpty()) {
-        int biggestCapture = 0;
-        for (const AIMove &move : captureMoves) {
-            const ChessPiece *target = position.board().pieceAt(move.toRow, move.toCol);
-            if (target && target->isValid()) {
-                biggestCapture = std::max(biggestCapture, m_evaluator->getPieceBaseValue(target->type()));
-            }
+    // Delta剪枝：吃掉最大的子也追不上 alpha 时不再搜索
+    int biggestCapture = 0;
+    for (const AIMove &move : captureMoves) {
+        quint8 target = position.board().pieceCode(move.toRow, move.toCol);
+        if (target != Board::EMPTY) {
+            biggestCapture = std::max(biggestCapture, m_evaluator->getPieceBaseValue(Board::pieceTypeOf(target)));
         }
+    }
 
-        const int DELTA_MARGIN = 200;
-        if (isMaximizing && standPat + biggestCapture + DELTA_MARGIN < alpha) {
-            return alpha;
-        }
-        if (!isMaximizing && standPat - biggestCapture - DELTA_MARGIN > beta) {
-            return beta;
-        }
+    const int DELTA_MARGIN = 200;
+    if (standPat + biggestCapture + DELTA_MARGIN < alpha) {
+        return standPat + biggestCapture + DELTA_MARGIN;
     }
 
-    // 只检查高价值吃子（SEE简化版）
-    QList<AIMove> goodCaptures;
-    for (const AIMove &move : captureMoves) {
-        const ChessPiece *target = position.board().pieceAt(move.toRow, move.toCol);
-        const ChessPiece *attacker = position.board().pieceAt(move.fromRow, move.fromCol);
-        if (target && target->isValid() && attacker && attacker->isValid()) {
-            if (m_evaluator->getPieceBaseValue(target->type()) >= m_evaluator->getPieceBaseValue(attacker->type()) - 100) {
-                goodCaptures.append(move);
-            }
+    // 只搜索不亏子的吃子：静态交换（SEE）为负的吃子被对方吃回后得不偿失；
+    // 交换所得加上站立评估和边界仍达不到 alpha 的吃子也不必搜索
+    MoveList goodCaptures;
+    for (AIMove &move : captureMoves) {
+        int exchange = m_evaluator->staticExchange(position.board(), move);
+        if (exchange >= 0 && standPat + exchange + DELTA_MARGIN > alpha) {
+            move.score = m_moveOrderer->captureScore(position, move);
+            goodCaptures.append(move);
         }
     }
 
@@ -340,91 +666,71 @@ int SearchEngine::quiescence(Position &position, int alpha, int beta, bool isMax
         return standPat;
     }
 
-    // 对吃子移动排序
-    m_moveOrderer->sortMoves(goodCaptures, position, 0);
+    // 按 MVV-LVA 排序（都已确认不亏子，无需再算静态交换）
+    std::sort(goodCaptures.begin(), goodCaptures.end(), [](const AIMove &a, const AIMove &b) {
+        return a.score > b.score;
+    });
 
-    if (isMaximizing) {
-        for (const AIMove &move : goodCaptures) {
-            Position tempPos = position;
-            tempPos.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-            tempPos.switchTurn();
+    int bestScore = standPat;
 
-            int score = quiescence(tempPos, alpha, beta, false, qsDepth + 1);
+    for (const AIMove &move : goodCaptures) {
+        UndoInfo undo;
+        position.makeMove(move, undo);
 
-            if (score >= beta) return beta;
-            if (score > alpha) alpha = score;
+        // 送将的吃子不合法
+        if (ChessRules::isInCheck(position.board(), currentColor)) {
+            position.unmakeMove(move, undo);
+            continue;
         }
-        return alpha;
-    } else {
-        for (const AIMove &move : goodCaptures) {
-            Position tempPos = position;
-            tempPos.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-            tempPos.switchTurn();
 
-            int score = quiescence(tempPos, alpha, beta, true, qsDepth + 1);
+        int score = -quiescence(position, -beta, -alpha, qsDepth + 1);
+        position.unmakeMove(move, undo);
+        if (isStopped()) return 0;
 
-            if (score <= alpha) return alpha;
-            if (score < beta) beta = score;
-        }
-        return beta;
+        if (score > bestScore) bestScore = score;
+        if (score >= beta) return score;
+        if (score > alpha) alpha = score;
     }
+    return bestScore;
 }
 
-QList<AIMove> SearchEngine::generateAllMoves(const Position &position, PieceColor color)
+void SearchEngine::generateAllMoves(const Position &position, PieceColor color, MoveList &moves)
 {
-    QList<AIMove> moves;
-
-    for (int fromRow = 0; fromRow < Board::ROWS; ++fromRow) {
-        for (int fromCol = 0; fromCol < Board::COLS; ++fromCol) {
-            const ChessPiece *piece = position.board().pieceAt(fromRow, fromCol);
-
-            if (!piece || !piece->isValid() || piece->color() != color) {
-                continue;
-            }
-
-            QList<QPoint> legalMoves = ChessRules::getLegalMoves(position.board(), fromRow, fromCol);
-
-            for (const QPoint &dest : legalMoves) {
-                moves.append(AIMove(fromRow, fromCol, dest.y(), dest.x()));
-            }
+    MoveList pseudoMoves;
+    ChessRules::generatePseudoLegalMoves(position.board(), color, pseudoMoves);
+
+    // 过滤掉送将的走法（只用于根节点等需要完整合法走法的场合）
+    Board board = position.board();
+    for (const AIMove &move : pseudoMoves) {
+        int fromSq = Board::toSquare(move.fromRow, move.fromCol);
+        int toSq = Board::toSquare(move.toRow, move.toCol);
+        quint8 captured = board.makeMove(fromSq, toSq);
+        if (!ChessRules::isInCheck(board, color)) {
+            moves.append(move);
         }
+        board.unmakeMove(fromSq, toSq, captured);
     }
-
-    return moves;
 }
 
-QList<AIMove> SearchEngine::generateCaptureMoves(const Position &position, PieceColor color)
+void SearchEngine::generateCaptureMoves(const Position &position, PieceColor color, MoveList &moves)
 {
-    QList<AIMove> moves;
-
-    for (int fromRow = 0; fromRow < Board::ROWS; ++fromRow) {
-        for (int fromCol = 0; fromCol < Board::COLS; ++fromCol) {
-            const ChessPiece *piece = position.board().pieceAt(fromRow, fromCol);
-
-            if (!piece || !piece->isValid() || piece->color() != color) {
-                continue;
-            }
-
-            QList<QPoint> legalMoves = ChessRules::getLegalMoves(position.board(), fromRow, fromCol);
-
-            for (const QPoint &dest : legalMoves) {
-                const ChessPiece *target = position.board().pieceAt(dest.y(), dest.x());
-                if (target && target->isValid() && target->color() != color) {
-                    moves.append(AIMove(fromRow, fromCol, dest.y(), dest.x()));
-                }
-            }
-        }
-    }
-
-    return moves;
+    ChessRules::generatePseudoLegalMoves(position.board(), color, moves, MoveGenType::Captures);
 }
 
-// 根节点并行搜索
-AIMove SearchEngine::parallelSearch(Position &position, int depth, bool isMaximizing, int threadCount)
+// Lazy SMP 并行搜索
+//
+// 主线程和 threadCount-1 个辅助线程同时对整个局面做迭代加深，
+// 每个辅助线程有自己的局面副本和走法排序器（杀手/历史表），只共享无锁置换表。
+// 一半辅助线程每次迭代多搜一层，各线程访问节点的顺序因此错开，
+// 彼此写入置换表的结果会让其他线程更快截断。主线程完成后停止所有辅助线程，采用主线程的结果。
+AIMove SearchEngine::parallelSearch(Position &position, const SearchLimits &limits, int threadCount)
 {
     qDebug() << "=== 并行搜索开始 ===";
 
-    // 确定使用的线程数
+    // 确定使用的线程数（未指定时使用 setThreadCount 的设置，仍为0则自动检测）
+    if (threadCount == 0) {
+        threadCount = m_threadCount;
+    }
     if (threadCount == 0) {
         threadCount = QThread::idealThreadCount();
         if (threadCount <= 0) threadCount = 4;  // 默认4线程
@@ -432,68 +738,61 @@ AIMove SearchEngine::parallelSearch(Position &position, int depth, bool isMaximi
 
     qDebug() << "使用" << threadCount << "个线程进行并行搜索";
 
-    PieceColor currentColor = position.currentTurn();
-    QList<AIMove> allMoves = generateAllMoves(position, currentColor);
+    // 辅助线程：各自独立的排序器、搜索引擎与局面（评估缓存不共享时还有各自的缓存）
+    struct Helper {
+        std::unique_ptr<MoveOrderer> orderer;
+        std::unique_ptr<EvalCache> evalCache;
+        std::unique_ptr<SearchEngine> engine;
+        Position position;
+    };
 
-    if (allMoves.isEmpty()) {
-        qDebug() << "没有可用的移动";
-        return AIMove();
+    std::vector<Helper> helpers;
+    helpers.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; ++i) {
+        Helper helper;
+        helper.orderer = std::make_unique<MoveOrderer>(m_evaluator);
+        EvalCache *evalCache = m_evalCache;
+        if (m_evalCache && !m_evalCacheShared) {
+            helper.evalCache = std::make_unique<EvalCache>(m_evalCache->sizeMB());
+            evalCache = helper.evalCache.get();
+        }
+        helper.engine = std::make_unique<SearchEngine>(m_transpositionTable, m_evaluator,
+                                                       helper.orderer.get(), evalCache);
+        helper.engine->m_isHelper = true;
+        helper.engine->m_depthOffset = i % 2;
+        helper.position = position;
+        helpers.push_back(std::move(helper));
     }
 
-    // 对移动进行排序
-    quint64 posKey = m_transpositionTable->computeZobristKey(position);
-    std::optional<AIMove> ttMove = m_transpositionTable->getBestMove(posKey);
-    m_moveOrderer->sortMoves(allMoves, position, 0, ttMove);
-
-    // 准备MoveScore列表
-    QList<MoveScore> moveScores;
-    for (const AIMove &move : allMoves) {
-        MoveScore ms;
-        ms.move = move;
-        ms.score = -INF;
-        ms.position = position;
-        ms.position.board().movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol);
-        ms.position.switchTurn();
-        moveScores.append(ms);
-    }
-
-    // Lambda函数：评估单个移动
-    auto evaluateMove = [this, depth, isMaximizing](const MoveScore &ms) -> MoveScore {
-        MoveScore result = ms;
-        Position tempPos = ms.position;
-        
-        result.score = pvs(tempPos, depth - 1, -INF, INF, !isMaximizing, true, depth);
-        
-        return result;
-    };
-
-    // 使用Qt并发框架并行评估所有移动
-    QList<MoveScore> results = QtConcurrent::blockingMapped(moveScores, evaluateMove);
+    // 使用独立线程池，保证所有辅助线程都能立即开始
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::max(1, threadCount - 1));
 
-    // 找到最佳移动
-    AIMove bestMove;
-    int bestScore = isMaximizing ? -INF : INF;
+    // 时间和节点限制只由主线程检查，辅助线程只限制深度，由主线程结束时停止
+    SearchLimits helperLimits = SearchLimits::fixedDepth(limits.depth);
 
-    for (const MoveScore &result : results) {
-        if (isMaximizing) {
-            if (result.score > bestScore) {
-                bestScore = result.score;
-                bestMove = result.move;
-            }
-        } else {
-            if (result.score < bestScore) {
-                bestScore = result.score;
-                bestMove = result.move;
-            }
-        }
+    QList<QFuture<void>> futures;
+    for (Helper &helper : helpers) {
+        futures.append(QtConcurrent::run(&pool, [&helper, helperLimits]() {
+            helper.engine->iterativeDeepening(helper.position, helperLimits);
+        }));
     }
 
-    // 存储到置换表
-    m_transpositionTable->store(posKey, depth, bestScore, TTEntry::EXACT, bestMove);
+    AIMove bestMove = iterativeDeepening(position, limits);
+
+    // 主线程完成后停止辅助线程，并汇总统计信息
+    for (Helper &helper : helpers) {
+        helper.engine->stop();
+    }
+    for (QFuture<void> &future : futures) {
+        future.waitForFinished();
+    }
+    for (const Helper &helper : helpers) {
+        addStatistics(*helper.engine);
+    }
 
     qDebug() << "并行搜索最佳移动:" << bestMove.fromRow << bestMove.fromCol
-             << "->" << bestMove.toRow << bestMove.toCol
-             << "评分:" << bestScore;
+             << "->" << bestMove.toRow << bestMove.toCol;
     qDebug() << "=== 并行搜索完成 ===";
 
     return bestMove;
@@ -2,37 +2,69 @@
 #define SEARCHENGINE_H
 
 #include "TranspositionTable.h"
+#include "EvalCache.h"
 #include "Evaluator.h"
 #include "MoveOrderer.h"
+#include "MovePicker.h"
+#include "SearchLimits.h"
+#include "PVLine.h"
 #include "../core/Position.h"
 #include "../core/ChessRules.h"
+#include "../core/MoveList.h"
 #include <QList>
+#include <QElapsedTimer>
 #include <QtConcurrent>
+#include <atomic>
+#include <functional>
 #include <limits>
 
 // 搜索引擎（负责所有搜索算法）
+//
+// 采用 negamax 形式：所有分数都以当前走子方为视角（正数表示走子方占优），
+// 子节点分数取反后即为父节点视角，同一套剪枝逻辑对红黑双方通用。
+// 将死分数为 MATE_SCORE - 距根节点的层数，存入置换表时换算为距当前节点的层数。
 class SearchEngine
 {
 public:
-    SearchEngine(TranspositionTable *tt, Evaluator *evaluator, MoveOrderer *orderer);
+    // evalCache 可以为空（不缓存静态评估）
+    SearchEngine(TranspositionTable *tt, Evaluator *evaluator, MoveOrderer *orderer,
+                 EvalCache *evalCache = nullptr);
 
-    // 迭代加深搜索（主入口）
-    AIMove iterativeDeepening(Position &position, int maxDepth, bool isMaximizing, AIMove *bestMove = nullptr);
+    // 迭代加深搜索（主入口，按 limits 的深度/时间/节点限制结束）
+    // limits.multiPV > 1 时每轮迭代依次搜出前几个根走法，结果由 pvLines() 取得
+    AIMove iterativeDeepening(Position &position, const SearchLimits &limits, AIMove *bestMove = nullptr);
 
-    // 根节点并行搜索
-    AIMove parallelSearch(Position &position, int depth, bool isMaximizing, int threadCount = 0);
+    // 最后一轮完整迭代的主要变例（按分数从高到低，条数为 multiPV 与根走法数的较小值）
+    const QList<PVLine> &pvLines() const { return m_pvLines; }
 
-    // PVS搜索（主要变例搜索）
-    int pvs(Position &position, int depth, int alpha, int beta, bool isMaximizing, bool isPV, int maxDepth);
+    // Lazy SMP 并行搜索：多个线程各自迭代加深，只通过共享置换表交换信息
+    AIMove parallelSearch(Position &position, const SearchLimits &limits, int threadCount = 0);
 
-    // 静态搜索（解决水平线效应）
-    int quiescence(Position &position, int alpha, int beta, bool isMaximizing, int qsDepth = 0);
+    // 请求停止当前搜索（可从其他线程调用，未完成的迭代结果会被丢弃）
+    void stop() { m_stopped.store(true, std::memory_order_relaxed); }
+    bool isStopped() const { return m_stopped.load(std::memory_order_relaxed); }
 
-    // 生成所有可能的移动
-    QList<AIMove> generateAllMoves(const Position &position, PieceColor color);
+    // 开始新的搜索：清除停止标志、开始计时并根据限制计算本步的软/硬时限
+    // （iterativeDeepening 会自动调用，直接调用 pvs 的场合需先调用）
+    void startSearch(const SearchLimits &limits);
 
-    // 生成吃子移动（用于静态搜索）
-    QList<AIMove> generateCaptureMoves(const Position &position, PieceColor color);
+    // 每完成一轮迭代的回调（深度、已搜索节点数），只由主线程调用
+    void setProgressCallback(std::function<void(int depth, int nodes)> callback) { m_progressCallback = std::move(callback); }
+
+    // 本次搜索已用时间（毫秒）
+    qint64 elapsedMs() const { return m_timer.isValid() ? m_timer.elapsed() : 0; }
+
+    // PVS搜索（主要变例搜索），返回走子方视角的软边界分数，ply 为距根节点的层数
+    int pvs(Position &position, int depth, int alpha, int beta, int ply, bool isPV);
+
+    // 静态搜索（解决水平线效应），返回走子方视角的软边界分数
+    int quiescence(Position &position, int alpha, int beta, int qsDepth = 0);
+
+    // 生成所有合法移动（根节点使用；内部节点生成伪合法走法，走子后再检查合法性）
+    void generateAllMoves(const Position &position, PieceColor color, MoveList &moves);
+
+    // 生成伪合法吃子移动（用于静态搜索，走子后再检查合法性）
+    void generateCaptureMoves(const Position &position, PieceColor color, MoveList &moves);
 
     // 获取统计信息
     int getNodesSearched() const { return m_nodesSearched; }
@@ -40,6 +72,9 @@ public:
     int getQsNodes() const { return m_qsNodes; }
     int getNullMoveCuts() const { return m_nullMoveCuts; }
     int getLmrReductions() const { return m_lmrReductions; }
+    int getSingularExtensions() const { return m_singularExtensions; }
+    int getEvalCacheProbes() const { return m_evalCacheProbes; }
+    int getEvalCacheHits() const { return m_evalCacheHits; }
     int getCurrentDepth() const { return m_currentDepth; }
 
     // 启用/禁用迭代加深
@@ -54,16 +89,44 @@ public:
     void setThreadCount(int count) { m_threadCount = count; }
     int getThreadCount() const { return m_threadCount; }
 
+    // 评估缓存模式：共享时所有线程使用同一个缓存，否则辅助线程各自新建同样大小的缓存
+    void setEvalCacheShared(bool shared) { m_evalCacheShared = shared; }
+    bool isEvalCacheShared() const { return m_evalCacheShared; }
+
     // 重置统计信息
     void resetStatistics();
 
 private:
-    // 空移动剪枝
-    int nullMoveSearch(Position &position, int depth, int beta, bool isMaximizing, int maxDepth);
+    // 根节点搜索（返回软边界分数）
+    // 只搜索 moves 中从 first 开始的走法（MultiPV 时前面的走法已有各自的变例）
+    int searchRoot(Position &position, const MoveList &moves, int first, int depth, int alpha, int beta, AIMove &best);
+
+    // 用 move 加上子节点的变例更新第 ply 层的主要变例
+    void updatePV(int ply, const AIMove &move);
+
+    // 根节点的主要变例（空时只含最佳走法）
+    PVLine rootPV(const AIMove &best, int score, int depth) const;
+
+    // 空移动剪枝（返回走子方视角的分数）
+    int nullMoveSearch(Position &position, int depth, int beta, int ply);
+
+    // 走子方视角的静态评估（Evaluator 以红方为视角，结果经评估缓存），inCheck 为走子方是否被将军
+    int evaluate(const Position &position, bool inCheck);
+
+    // 将死分数在"距根节点"与"距当前节点"之间换算（置换表中的表项可能在不同层被命中）
+    static int scoreToTT(int score, int ply);
+    static int scoreFromTT(int score, int ply);
+
+    // 把辅助线程的统计信息累加到本引擎
+    void addStatistics(const SearchEngine &other);
+
+    // 每隔 CHECK_INTERVAL 个节点检查一次硬时限和节点数，超出时设置停止标志
+    void checkLimits();
 
     TranspositionTable *m_transpositionTable;
     Evaluator *m_evaluator;
     MoveOrderer *m_moveOrderer;
+    EvalCache *m_evalCache;
 
     // 统计信息
     int m_nodesSearched;
@@ -71,23 +134,53 @@ private:
     int m_qsNodes;
     int m_nullMoveCuts;
     int m_lmrReductions;
+    int m_singularExtensions;
+    int m_evalCacheProbes;
+    int m_evalCacheHits;
     int m_currentDepth;
 
     // 选项
     bool m_useIterativeDeepening;
     bool m_useParallelSearch;
     int m_threadCount;  // 0表示自动检测
+    bool m_evalCacheShared;
+
+    // 并行搜索状态
+    std::atomic<bool> m_stopped;  // 停止标志
+    bool m_isHelper;              // 是否为 Lazy SMP 辅助线程（不输出调试信息，不更新当前深度）
+    int m_depthOffset;            // 辅助线程每次迭代比主线程多搜的层数，使各线程的搜索树错开
+
+    // 搜索限制
+    SearchLimits m_limits;
+    QElapsedTimer m_timer;
+    qint64 m_softLimitMs;  // 超过后不再开始新一轮迭代（0 表示不限）
+    qint64 m_hardLimitMs;  // 超过后立即停止搜索（0 表示不限）
+    int m_checkCountdown;  // 距下次检查限制还剩的节点数
+
+    std::function<void(int depth, int nodes)> m_progressCallback;
+
+    // 主要变例（三角形数组：第 ply 行保存从第 ply 层开始的变例，长度为 m_pvLength[ply]）
+    static constexpr int MAX_PLY = 128;
+    AIMove m_pvTable[MAX_PLY][MAX_PLY];
+    int m_pvLength[MAX_PLY];
 
-    // 并行搜索辅助结构
-    struct MoveScore {
-        AIMove move;
-        int score;
-        Position position;  // 执行移动后的局面
-    };
+    // 每层被排除的走法（奇异扩展验证搜索时为置换表走法，否则无效）
+    AIMove m_excludedMoves[MAX_PLY];
+    QList<PVLine> m_pvLines;
 
     // 常量定义
     static constexpr int INF = std::numeric_limits<int>::max() / 2;
-    static constexpr int MATE_SCORE = 100000;
+    static constexpr int MATE_SCORE = 30000;  // 需能放入置换表的16位分数
+    static constexpr int MAX_SEARCH_DEPTH = 64;   // 不限深度时的迭代上限
+    static constexpr int MATE_BOUND = MATE_SCORE - 2 * MAX_SEARCH_DEPTH;  // 超过此值视为将死分数
+    static constexpr int BAN_SCORE = MATE_BOUND - 1;  // 长将/长捉判负的分数（不随层数变化，低于将死分数）
+    static constexpr int ASPIRATION_WINDOW = 50;  // 渴望窗口初始半宽（半个兵）
+    static constexpr int ASPIRATION_MIN_DEPTH = 4; // 从这一深度起使用渴望窗口
+    static constexpr int SINGULAR_MIN_DEPTH = 6;  // 从这一剩余深度起尝试奇异扩展
+    static constexpr int SINGULAR_MARGIN = 5;     // 奇异扩展的边界：置换表分数 - 每层5分
+    static constexpr int CHECK_INTERVAL = 1024;   // 检查时间/节点限制的间隔
+    static constexpr qint64 MOVE_OVERHEAD_MS = 30; // 为走子和界面响应预留的时间
+    static_assert(MATE_SCORE < TranspositionTable::SCORE_LIMIT, "将死分数超出置换表分数范围");
 };
 
 #endif // SEARCHENGINE_H
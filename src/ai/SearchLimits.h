@@ -0,0 +1,41 @@
+#ifndef SEARCHLIMITS_H
+#define SEARCHLIMITS_H
+
+#include <QtTypes>
+#include <atomic>
+
+// 搜索限制
+//
+// 各项为0表示不限制，可以组合使用：任何一项先到达都会结束搜索。
+// 按时间限制时，迭代加深总是返回最后一轮完整迭代的最佳走法。
+struct SearchLimits {
+    int depth = 0;             // 最大搜索深度
+    qint64 moveTimeMs = 0;     // 本步固定用时（毫秒）
+    qint64 remainingMs = 0;    // 己方剩余时间（毫秒），与 incrementMs / movesToGo 一起分配本步用时
+    qint64 incrementMs = 0;    // 每步加秒（毫秒）
+    int movesToGo = 0;         // 距下次加时的步数（0 表示按剩余时间估算）
+    qint64 nodes = 0;          // 最大搜索节点数
+    int multiPV = 1;           // 输出的主要变例条数（按分数从高到低的前几个根走法）
+
+    // 外部停止标志（可选）：由发起搜索的一方持有，置位后搜索尽快结束。
+    // 与 ChessAI::stop 不同，它在搜索真正开始前置位也不会丢失。
+    const std::atomic<bool> *stopFlag = nullptr;
+
+    bool hasTimeLimit() const { return moveTimeMs > 0 || remainingMs > 0; }
+
+    // 只限制深度
+    static SearchLimits fixedDepth(int depth) {
+        SearchLimits limits;
+        limits.depth = depth;
+        return limits;
+    }
+
+    // 固定每步用时
+    static SearchLimits fixedTime(qint64 ms) {
+        SearchLimits limits;
+        limits.moveTimeMs = ms;
+        return limits;
+    }
+};
+
+#endif // SEARCHLIMITS_H
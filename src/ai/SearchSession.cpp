@@ -0,0 +1,109 @@
+#include "SearchSession.h"
+#include <QDebug>
+#include <QtConcurrent/QtConcurrent>
+
+SearchSession::SearchSession(ChessAI *ai, QObject *parent)
+    : QObject(parent)
+    , m_ai(ai)
+    , m_running(false)
+    , m_discardResult(false)
+    , m_hasPending(false)
+{
+    m_watcher = new QFutureWatcher<AIMove>(this);
+    connect(m_watcher, &QFutureWatcher<AIMove>::finished, this, &SearchSession::onWorkerFinished);
+
+    // 进度在搜索线程中发出，排队到本对象所在线程后再转发
+    connect(m_ai, &ChessAI::searchProgress, this, [this](int depth, int nodes) {
+        if (isSearching()) {
+            emit progress(depth, nodes);
+        }
+    });
+}
+
+SearchSession::~SearchSession()
+{
+    cancel();
+    waitForFinished();
+}
+
+void SearchSession::start(const Position &position, const SearchLimits &limits)
+{
+    m_pendingPosition = position;
+    m_pendingLimits = m_ai->effectiveLimits(limits);  // 在本线程读取难度，搜索线程只使用快照
+    m_hasPending = true;
+
+    if (m_running) {
+        // 旧搜索退出后在 onWorkerFinished 中启动
+        abortCurrent();
+        return;
+    }
+
+    launch();
+}
+
+void SearchSession::stop()
+{
+    if (m_stopFlag) {
+        m_stopFlag->store(true, std::memory_order_relaxed);
+    }
+}
+
+void SearchSession::cancel()
+{
+    m_hasPending = false;
+    abortCurrent();
+}
+
+void SearchSession::waitForFinished()
+{
+    m_watcher->waitForFinished();
+}
+
+void SearchSession::launch()
+{
+    m_hasPending = false;
+    m_running = true;
+    m_discardResult = false;
+    m_stopFlag = std::make_shared<std::atomic<bool>>(false);
+
+    SearchLimits limits = m_pendingLimits;
+    limits.stopFlag = m_stopFlag.get();
+
+    // 后台线程只访问局面快照；任务持有停止标志的引用，保证搜索期间标志一直有效
+    ChessAI *ai = m_ai;
+    Position position = m_pendingPosition;
+    std::shared_ptr<std::atomic<bool>> stopFlag = m_stopFlag;
+    m_watcher->setFuture(QtConcurrent::run([ai, position, limits, stopFlag]() {
+        return ai->getBestMove(position, limits);
+    }));
+
+    emit started();
+}
+
+void SearchSession::abortCurrent()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_discardResult = true;
+    stop();
+}
+
+void SearchSession::onWorkerFinished()
+{
+    AIMove move = m_watcher->result();
+    bool discard = m_discardResult;
+    m_running = false;
+
+    if (m_hasPending) {
+        launch();
+    }
+
+    if (discard) {
+        qDebug() << "丢弃已取消的搜索结果";
+        return;
+    }
+
+    emit finished(move);
+}
@@ -0,0 +1,63 @@
+#ifndef SEARCHSESSION_H
+#define SEARCHSESSION_H
+
+#include "ChessAI.h"
+#include "SearchLimits.h"
+#include "../core/Position.h"
+#include <QObject>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+
+// 异步搜索会话
+//
+// 在后台线程中用 ChessAI 搜索调用时局面的快照，GUI 线程从不等待搜索。
+// 同一时刻只有一个后台搜索：重新开始时先让旧搜索停止，旧搜索退出后再启动新的；
+// 被取消或被替换的搜索结果直接丢弃，不会发出 finished。
+class SearchSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SearchSession(ChessAI *ai, QObject *parent = nullptr);
+    ~SearchSession() override;
+
+    // 搜索 position 的快照（已有搜索时取消它并重新开始）
+    // 搜索限制在调用时按当前难度补全，之后修改 ChessAI 的难度不影响这次搜索
+    void start(const Position &position, const SearchLimits &limits = SearchLimits());
+
+    // 让当前搜索尽快结束，照常发出 finished（结果为最后一轮完整迭代的最佳走法）
+    void stop();
+
+    // 取消当前搜索和等待启动的搜索，结果被丢弃
+    void cancel();
+
+    // 是否有搜索在进行（不含已取消的搜索）
+    bool isSearching() const { return m_running && !m_discardResult; }
+
+    // 阻塞等待后台搜索退出（只在析构等必须确保 ChessAI 不再被访问的场合使用）
+    void waitForFinished();
+
+signals:
+    void started();
+    void progress(int depth, int nodes);
+    void finished(const AIMove &move);
+
+private:
+    void launch();
+    void abortCurrent();
+    void onWorkerFinished();
+
+    ChessAI *m_ai;
+    QFutureWatcher<AIMove> *m_watcher;
+    std::shared_ptr<std::atomic<bool>> m_stopFlag;  // 当前后台搜索的停止标志
+    bool m_running;        // 后台搜索是否尚未退出
+    bool m_discardResult;  // 当前后台搜索的结果是否作废
+
+    // 等待旧搜索退出后启动的搜索
+    bool m_hasPending;
+    Position m_pendingPosition;
+    SearchLimits m_pendingLimits;
+};
+
+#endif // SEARCHSESSION_H
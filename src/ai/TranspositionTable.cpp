@@ -1,155 +1,166 @@
 #include "TranspositionTable.h"
-#include "../core/Board.h"
-#include <QRandomGenerator>
+#include <QDebug>
+#include <QtGlobal>
 
-TranspositionTable::TranspositionTable()
-    : m_initialized(false)
-    , m_hits(0)
-    , m_threadSafe(true)
-{
-    initialize();
-}
+namespace {
 
-void TranspositionTable::initialize()
-{
-    if (m_initialized) return;
+// 数据字各字段
+inline int moveBits(quint64 data) { return int(data & 0xFFFF); }
+inline int scoreBits(quint64 data) { return qint16(quint16(data >> 16)); }
+inline int depthBits(quint64 data) { return int((data >> 32) & 0xFF); }
+inline int boundBits(quint64 data) { return int((data >> 40) & 0x3); }
+inline int generationBits(quint64 data) { return int((data >> 42) & 0x3F); }
+inline quint64 keyFragment(quint64 key) { return key >> 48; }
 
-    QRandomGenerator *rng = QRandomGenerator::global();
-
-    for (int row = 0; row < 10; row++) {
-        for (int col = 0; col < 9; col++) {
-            for (int piece = 0; piece < 14; piece++) {
-                m_zobristTable[row][col][piece] = (quint64(rng->generate()) << 32) | rng->generate();
-            }
-        }
+// 走法编码：起点格与终点格各7位，0 表示无走法（起点与终点不可能相同）
+quint64 packMove(const AIMove &move)
+{
+    if (!move.isValid()) {
+        return 0;
     }
-
-    m_initialized = true;
+    return quint64(Board::toSquare(move.fromRow, move.fromCol))
+         | quint64(Board::toSquare(move.toRow, move.toCol)) << 7;
 }
 
-quint64 TranspositionTable::computeZobristKey(const Position &position)
+AIMove unpackMove(int bits)
 {
-    quint64 key = 0;
-
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = position.board().pieceAt(row, col);
-            if (piece && piece->isValid()) {
-                int pieceIndex = static_cast<int>(piece->type()) + (piece->color() == PieceColor::Black ? 7 : 0);
-                key ^= m_zobristTable[row][col][pieceIndex];
-            }
-        }
+    if (bits == 0) {
+        return AIMove();
     }
-
-    return key;
+    int fromSq = bits & 0x7F;
+    int toSq = (bits >> 7) & 0x7F;
+    return AIMove(Board::squareRow(fromSq), Board::squareCol(fromSq),
+                  Board::squareRow(toSq), Board::squareCol(toSq));
 }
 
-bool TranspositionTable::probe(quint64 key, int depth, int alpha, int beta, int &score)
+} // namespace
+
+TranspositionTable::TranspositionTable(int sizeMB)
+    : m_bucketMask(0)
+    , m_sizeMB(0)
+    , m_generation(0)
+    , m_hits(0)
 {
-    if (m_threadSafe) {
-        QMutexLocker locker(&m_mutex);
-        return probeImpl(key, depth, alpha, beta, score);
-    } else {
-        return probeImpl(key, depth, alpha, beta, score);
-    }
+    resize(sizeMB);
 }
 
-bool TranspositionTable::probeImpl(quint64 key, int depth, int alpha, int beta, int &score)
+void TranspositionTable::resize(int sizeMB)
 {
-    if (!m_table.contains(key)) {
-        return false;
-    }
+    if (sizeMB < 1) sizeMB = 1;
 
-    const TTEntry &entry = m_table[key];
+    // 桶数取不超过预算的最大 2 的幂
+    quint64 budget = quint64(sizeMB) * 1024 * 1024 / sizeof(Bucket);
+    quint64 count = 1;
+    while (count * 2 <= budget) count *= 2;
 
-    if (entry.depth < depth) {
-        return false;
-    }
+    m_buckets = std::make_unique<Bucket[]>(count);
+    m_bucketMask = count - 1;
+    m_sizeMB = int(count * sizeof(Bucket) / (1024 * 1024));
+    clear();
 
-    if (entry.flag == TTEntry::EXACT) {
-        score = entry.score;
-        m_hits++;
-        return true;
-    }
+    qDebug() << "置换表大小:" << m_sizeMB << "MB," << count * ENTRIES_PER_BUCKET << "个表项";
+}
 
-    if (entry.flag == TTEntry::LOWER_BOUND && entry.score >= beta) {
-        score = entry.score;
-        m_hits++;
-        return true;
-    }
+quint64 TranspositionTable::pack(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove) const
+{
+    score = qBound(-SCORE_LIMIT, score, SCORE_LIMIT);
+    depth = qBound(0, depth, 255);
+
+    return packMove(bestMove)
+         | quint64(quint16(qint16(score))) << 16
+         | quint64(depth) << 32
+         | quint64(flag + 1) << 40
+         | quint64(m_generation) << 42
+         | keyFragment(key) << 48;
+}
+
+void TranspositionTable::unpack(quint64 data, TTEntry &entry)
+{
+    entry.bestMove = unpackMove(moveBits(data));
+    entry.score = scoreBits(data);
+    entry.depth = depthBits(data);
+    entry.flag = static_cast<TTEntry::Flag>(boundBits(data) - 1);
+}
 
-    if (entry.flag == TTEntry::UPPER_BOUND && entry.score <= alpha) {
-        score = entry.score;
-        m_hits++;
+bool TranspositionTable::lookup(quint64 key, TTEntry &entry) const
+{
+    const Bucket &bucket = bucketFor(key);
+    for (const Entry &slot : bucket.entries) {
+        quint64 data = slot.data.load(std::memory_order_relaxed);
+        quint64 check = slot.check.load(std::memory_order_relaxed);
+
+        // 空表项或校验失败（键不同或被并发写入撕裂）
+        if (boundBits(data) == 0 || (check ^ data) != key) {
+            continue;
+        }
+
+        entry.zobristKey = key;
+        unpack(data, entry);
         return true;
     }
-
     return false;
 }
 
-void TranspositionTable::store(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove)
+bool TranspositionTable::probe(quint64 key, TTEntry &entry)
 {
-    if (m_threadSafe) {
-        QMutexLocker locker(&m_mutex);
-        storeImpl(key, depth, score, flag, bestMove);
-    } else {
-        storeImpl(key, depth, score, flag, bestMove);
+    if (!lookup(key, entry)) {
+        return false;
     }
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
-void TranspositionTable::storeImpl(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove)
+void TranspositionTable::store(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove)
 {
-    // 如果已存在该键
-    if (m_table.contains(key)) {
-        TTEntry &existing = m_table[key];
-        // 只有当新结果深度更深或相等时才替换（深度优先策略）
-        if (depth >= existing.depth) {
-            existing.zobristKey = key;
-            existing.depth = depth;
-            existing.score = score;
-            existing.flag = flag;
-            existing.bestMove = bestMove;
+    Bucket &bucket = bucketFor(key);
+    Entry *replace = nullptr;
+    int worstValue = 0;
+    AIMove move = bestMove;
+
+    for (Entry &slot : bucket.entries) {
+        quint64 data = slot.data.load(std::memory_order_relaxed);
+
+        // 空表项：直接使用
+        if (boundBits(data) == 0) {
+            replace = &slot;
+            break;
         }
-        return;
-    }
 
-    // 如果表满了，使用简单的替换策略
-    if (m_table.size() >= TT_SIZE) {
-        // 直接删除第一个元素（FIFO策略，简单高效）
-        auto it = m_table.begin();
-        m_table.erase(it);
-    }
+        // 同一局面：覆盖原表项，没有新走法时保留旧走法
+        if ((data >> 48) == keyFragment(key)
+            && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            if (!move.isValid()) {
+                move = unpackMove(moveBits(data));
+            }
+            // 本轮搜索中更深的非精确结果不被浅层结果覆盖
+            if (flag != TTEntry::EXACT && generationBits(data) == m_generation
+                && depth + 2 < depthBits(data)) {
+                return;
+            }
+            replace = &slot;
+            break;
+        }
 
-    // 存储新项
-    TTEntry entry;
-    entry.zobristKey = key;
-    entry.depth = depth;
-    entry.score = score;
-    entry.flag = flag;
-    entry.bestMove = bestMove;
+        // 否则淘汰 深度 - 年龄 最小的表项
+        int age = (m_generation - generationBits(data)) & GENERATION_MASK;
+        int value = depthBits(data) - 8 * age;
+        if (!replace || value < worstValue) {
+            replace = &slot;
+            worstValue = value;
+        }
+    }
 
-    m_table[key] = entry;
+    quint64 data = pack(key, depth, score, flag, move);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
 }
 
 std::optional<AIMove> TranspositionTable::getBestMove(quint64 key)
 {
-    if (m_threadSafe) {
-        QMutexLocker locker(&m_mutex);
-        return getBestMoveImpl(key);
-    } else {
-        return getBestMoveImpl(key);
-    }
-}
-
-std::optional<AIMove> TranspositionTable::getBestMoveImpl(quint64 key)
-{
-    if (!m_table.contains(key)) {
-        return std::nullopt;
-    }
-
-    TTEntry &entry = m_table[key];
-    if (entry.bestMove.isValid()) {
-        return entry.bestMove;  // 返回值拷贝，线程安全
+    TTEntry entry;
+    if (lookup(key, entry) && entry.bestMove.isValid()) {
+        return entry.bestMove;
     }
 
     return std::nullopt;
@@ -157,10 +168,16 @@ std::optional<AIMove> TranspositionTable::getBestMoveImpl(quint64 key)
 
 void TranspositionTable::clear()
 {
-    m_table.clear();
+    for (quint64 i = 0; i <= m_bucketMask; ++i) {
+        for (Entry &slot : m_buckets[i].entries) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_generation = 0;
 }
 
 void TranspositionTable::resetStatistics()
 {
-    m_hits = 0;
+    m_hits.store(0, std::memory_order_relaxed);
 }
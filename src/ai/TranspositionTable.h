@@ -2,26 +2,13 @@
 #define TRANSPOSITIONTABLE_H
 
 #include "../core/Position.h"
-#include <QHash>
+#include "../core/Move.h"
 #include <QtTypes>
-#include <QMutex>
-#include <QMutexLocker>
+#include <atomic>
+#include <memory>
 #include <optional>
 
-// 移动结构（包含评分）
-struct AIMove {
-    int fromRow, fromCol;
-    int toRow, toCol;
-    int score;
-
-    AIMove() : fromRow(-1), fromCol(-1), toRow(-1), toCol(-1), score(0) {}
-    AIMove(int fr, int fc, int tr, int tc, int s = 0)
-        : fromRow(fr), fromCol(fc), toRow(tr), toCol(tc), score(s) {}
-
-    bool isValid() const { return fromRow >= 0 && fromCol >= 0 && toRow >= 0 && toCol >= 0; }
-};
-
-// 置换表项
+// 置换表项（解码后的值，供查询结果使用）
 struct TTEntry {
     quint64 zobristKey;
     int depth;
@@ -32,60 +19,86 @@ struct TTEntry {
     TTEntry() : zobristKey(0), depth(-1), score(0), flag(EXACT) {}
 };
 
-// 置换表管理器（线程安全版本）
+// 置换表管理器（无锁版本）
+//
+// 预分配 2 的幂个桶，每个桶占一条缓存行（64 字节），内含 4 个 16 字节表项。
+// 表项由校验字和数据字组成，校验字 = key ^ 数据字，读取时重新异或校验，
+// 多线程并发写入造成的撕裂数据会被当作未命中丢弃，读写都无需加锁。
+//
+// 数据字布局（共64位）：
+//   [0..15]  走法：起点格(7位) | 终点格(7位)，0 表示无走法
+//   [16..31] 分数（int16）
+//   [32..39] 深度
+//   [40..41] 边界类型（标志+1，0 表示空表项）
+//   [42..47] 搜索代数
+//   [48..63] 键片段（键的高16位，替换时快速筛选）
+//
+// 每次 newSearch() 代数加一，替换时优先淘汰 深度 - 年龄 最小的表项，
+// 因此旧搜索留下的表项会自然被覆盖，走子之间无需 clear()。
 class TranspositionTable
 {
 public:
-    TranspositionTable();
+    static constexpr int DEFAULT_SIZE_MB = 64;
+
+    // 可存储的分数范围（超出会被截断，需大于将死分数）
+    static constexpr int SCORE_LIMIT = 32000;
+
+    explicit TranspositionTable(int sizeMB = DEFAULT_SIZE_MB);
 
-    // 初始化Zobrist键值
-    void initialize();
+    // 重新分配置换表大小（MB，向下取整到 2 的幂个桶），会清空内容
+    void resize(int sizeMB);
+    int sizeMB() const { return m_sizeMB; }
 
-    // 计算局面的Zobrist哈希值
-    quint64 computeZobristKey(const Position &position);
+    // 开始新一轮搜索（搜索代数加一）
+    void newSearch() { m_generation = (m_generation + 1) & GENERATION_MASK; }
 
-    // 查询置换表（线程安全）
-    bool probe(quint64 key, int depth, int alpha, int beta, int &score);
+    // 查询置换表（命中时填充 entry，是否可以截断由搜索按深度和边界类型判断）
+    bool probe(quint64 key, TTEntry &entry);
 
-    // 存储到置换表（线程安全）
+    // 存储到置换表
     void store(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove);
 
-    // 获取最佳移动（如果有）（线程安全，返回optional）
+    // 获取最佳移动（如果有）
     std::optional<AIMove> getBestMove(quint64 key);
 
     // 清空置换表
     void clear();
 
     // 获取命中次数
-    int getHits() const { return m_hits; }
+    int getHits() const { return m_hits.load(std::memory_order_relaxed); }
 
     // 重置统计信息
     void resetStatistics();
 
-    // 启用/禁用线程安全（默认启用）
-    void setThreadSafe(bool enabled) { m_threadSafe = enabled; }
-    bool isThreadSafe() const { return m_threadSafe; }
-
 private:
-    QHash<quint64, TTEntry> m_table;
-    quint64 m_zobristTable[10][9][14];  // [row][col][piece]
-    bool m_initialized;
-    int m_hits;
-    bool m_threadSafe;
-
-    // 线程安全锁
-    mutable QMutex m_mutex;
-
-    // 辅助函数：实际的查询逻辑（无锁版本）
-    bool probeImpl(quint64 key, int depth, int alpha, int beta, int &score);
-
-    // 辅助函数：实际的存储逻辑（无锁版本）
-    void storeImpl(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove);
-
-    // 辅助函数：实际的获取最佳移动逻辑（无锁版本）
-    std::optional<AIMove> getBestMoveImpl(quint64 key);
-
-    static constexpr int TT_SIZE = 1000000;  // 约100万个表项
+    struct Entry {
+        std::atomic<quint64> check;  // key ^ data
+        std::atomic<quint64> data;   // 打包后的表项内容
+    };
+
+    static constexpr int ENTRIES_PER_BUCKET = 4;
+    static constexpr int GENERATION_MASK = 63;
+
+    struct alignas(64) Bucket {
+        Entry entries[ENTRIES_PER_BUCKET];
+    };
+    static_assert(sizeof(Entry) == 16, "表项应为16字节");
+    static_assert(sizeof(Bucket) == 64, "每个桶应恰好占一条缓存行");
+
+    // 打包/解包数据字
+    quint64 pack(quint64 key, int depth, int score, TTEntry::Flag flag, const AIMove &bestMove) const;
+    static void unpack(quint64 data, TTEntry &entry);
+
+    // 查找与 key 匹配的表项
+    bool lookup(quint64 key, TTEntry &entry) const;
+
+    Bucket &bucketFor(quint64 key) const { return m_buckets[key & m_bucketMask]; }
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    quint64 m_bucketMask;
+    int m_sizeMB;
+    int m_generation;
+    std::atomic<int> m_hits;
 };
 
 #endif // TRANSPOSITIONTABLE_H
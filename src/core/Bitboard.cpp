@@ -0,0 +1,139 @@
+#include "Bitboard.h"
+
+namespace {
+
+bool onBoard(int row, int col)
+{
+    return row >= 0 && row < Bitboard::ROWS && col >= 0 && col < Bitboard::COLS;
+}
+
+bool inPalace(int row, int col, int side)
+{
+    if (!onBoard(row, col) || col < 3 || col > 5) return false;
+    return side == 0 ? row >= 7 : row <= 2;  // 红方九宫在下（7-9行），黑方在上（0-2行）
+}
+
+bool inOwnHalf(int row, int side)
+{
+    return side == 0 ? row >= 5 : row <= 4;
+}
+
+void addStep(Bitboard::StepList &list, int to, int block)
+{
+    list.steps[list.count].to = static_cast<qint8>(to);
+    list.steps[list.count].block = static_cast<qint8>(block);
+    ++list.count;
+}
+
+// 直线滑动：沿 pos 两侧扫描长度为 length 的占用位
+// 车：到达第一个阻挡子为止（含阻挡子）；炮：越过第一个阻挡子后的下一个子
+void buildLine(int pos, int occ, int length, quint16 &rook, quint16 &cannon)
+{
+    rook = 0;
+    cannon = 0;
+    for (int dir = -1; dir <= 1; dir += 2) {
+        bool screened = false;
+        for (int i = pos + dir; i >= 0 && i < length; i += dir) {
+            bool occupied = (occ >> i) & 1;
+            if (!screened) {
+                rook |= quint16(1 << i);
+                if (occupied) screened = true;
+            } else if (occupied) {
+                cannon |= quint16(1 << i);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+const Bitboard::Tables Bitboard::s_tables = Bitboard::buildTables();
+
+Bitboard::Tables Bitboard::buildTables()
+{
+    Tables t{};
+
+    static const int orthogonal[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    static const int diagonal[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+    static const int horseJumps[8][4] = {  // 行偏移、列偏移、马腿行偏移、马腿列偏移
+        {-2, -1, -1, 0}, {-2, 1, -1, 0}, {2, -1, 1, 0}, {2, 1, 1, 0},
+        {-1, -2, 0, -1}, {1, -2, 0, -1}, {-1, 2, 0, 1}, {1, 2, 0, 1}
+    };
+
+    for (int square = 0; square < SQUARES; ++square) {
+        int row = square / COLS;
+        int col = square % COLS;
+
+        for (int s = 0; s < 2; ++s) {
+            // 将/帅：九宫内直走一步
+            if (inPalace(row, col, s)) {
+                for (const auto &d : orthogonal) {
+                    int r = row + d[0], c = col + d[1];
+                    if (inPalace(r, c, s)) addStep(t.king[s][square], r * COLS + c, -1);
+                }
+                // 士/仕：九宫内斜走一步
+                for (const auto &d : diagonal) {
+                    int r = row + d[0], c = col + d[1];
+                    if (inPalace(r, c, s)) addStep(t.advisor[s][square], r * COLS + c, -1);
+                }
+            }
+
+            // 象/相：己方半场斜走两步，象眼为中点
+            if (inOwnHalf(row, s)) {
+                for (const auto &d : diagonal) {
+                    int r = row + 2 * d[0], c = col + 2 * d[1];
+                    if (onBoard(r, c) && inOwnHalf(r, s)) {
+                        addStep(t.elephant[s][square], r * COLS + c, (row + d[0]) * COLS + col + d[1]);
+                    }
+                }
+            }
+
+            // 兵/卒：向前一步，过河后可左右平移
+            int forward = (s == 0) ? -1 : 1;
+            if (onBoard(row + forward, col)) {
+                addStep(t.pawn[s][square], (row + forward) * COLS + col, -1);
+            }
+            if (!inOwnHalf(row, s)) {
+                if (col > 0) addStep(t.pawn[s][square], square - 1, -1);
+                if (col < COLS - 1) addStep(t.pawn[s][square], square + 1, -1);
+            }
+        }
+
+        // 马：日字，马腿为紧邻起点的直线格
+        for (const auto &j : horseJumps) {
+            int r = row + j[0], c = col + j[1];
+            if (onBoard(r, c)) {
+                addStep(t.horse[square], r * COLS + c, (row + j[2]) * COLS + col + j[3]);
+            }
+        }
+    }
+
+    // 反向表：能攻击某格的马 / 兵
+    for (int square = 0; square < SQUARES; ++square) {
+        const StepList &horse = t.horse[square];
+        for (int i = 0; i < horse.count; ++i) {
+            addStep(t.horseAttackers[horse.steps[i].to], square, horse.steps[i].block);
+        }
+        for (int s = 0; s < 2; ++s) {
+            const StepList &pawn = t.pawn[s][square];
+            for (int i = 0; i < pawn.count; ++i) {
+                addStep(t.pawnAttackers[s][pawn.steps[i].to], square, -1);
+            }
+        }
+    }
+
+    // 直线表
+    for (int col = 0; col < COLS; ++col) {
+        for (int occ = 0; occ < (1 << COLS); ++occ) {
+            buildLine(col, occ, COLS, t.rankRook[col][occ], t.rankCannon[col][occ]);
+        }
+    }
+    for (int row = 0; row < ROWS; ++row) {
+        for (int occ = 0; occ < (1 << ROWS); ++occ) {
+            buildLine(row, occ, ROWS, t.fileRook[row][occ], t.fileCannon[row][occ]);
+        }
+    }
+
+    return t;
+}
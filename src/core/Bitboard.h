@@ -0,0 +1,120 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "ChessPiece.h"
+#include <QtTypes>
+#include <bit>
+
+// 90 位棋盘掩码（两个 64 位字，格子下标 = 行 * 9 + 列）
+struct BitMask {
+    quint64 lo = 0;  // 格子 0-63
+    quint64 hi = 0;  // 格子 64-89
+
+    static constexpr quint64 HI_MASK = (quint64(1) << 26) - 1;
+
+    void set(int square) {
+        if (square < 64) lo |= quint64(1) << square;
+        else hi |= quint64(1) << (square - 64);
+    }
+    void reset(int square) {
+        if (square < 64) lo &= ~(quint64(1) << square);
+        else hi &= ~(quint64(1) << (square - 64));
+    }
+    bool test(int square) const {
+        return square < 64 ? (lo >> square) & 1 : (hi >> (square - 64)) & 1;
+    }
+
+    bool isEmpty() const { return (lo | hi) == 0; }
+    int count() const { return std::popcount(lo) + std::popcount(hi); }
+
+    // 取出并清除最低位的格子（调用方需保证非空）
+    int popLowest() {
+        if (lo) {
+            int square = std::countr_zero(lo);
+            lo &= lo - 1;
+            return square;
+        }
+        int square = 64 + std::countr_zero(hi);
+        hi &= hi - 1;
+        return square;
+    }
+
+    BitMask operator&(const BitMask &o) const { return {lo & o.lo, hi & o.hi}; }
+    BitMask operator|(const BitMask &o) const { return {lo | o.lo, hi | o.hi}; }
+    BitMask operator^(const BitMask &o) const { return {lo ^ o.lo, hi ^ o.hi}; }
+    BitMask operator~() const { return {~lo, ~hi & HI_MASK}; }
+    BitMask &operator&=(const BitMask &o) { lo &= o.lo; hi &= o.hi; return *this; }
+    BitMask &operator|=(const BitMask &o) { lo |= o.lo; hi |= o.hi; return *this; }
+    BitMask &operator^=(const BitMask &o) { lo ^= o.lo; hi ^= o.hi; return *this; }
+    bool operator==(const BitMask &o) const { return lo == o.lo && hi == o.hi; }
+};
+
+// 预计算走法/攻击表（静态类）
+//
+// 车、炮的直线走法按"行/列占用位"查表：一行9格共512种占用，一列10格共1024种，
+// 表中直接给出可到达的位，走法生成只需遍历真实目标。
+// 将、士、象、马、兵按起点格预先列出目标格，并附带马腿/象眼格用于判断是否被阻挡。
+class Bitboard
+{
+public:
+    static const int ROWS = 10;
+    static const int COLS = 9;
+    static const int SQUARES = ROWS * COLS;
+
+    // 单步走法：目标格与阻挡格（马腿/象眼，-1 表示无）
+    struct Step {
+        qint8 to;
+        qint8 block;
+    };
+
+    struct StepList {
+        Step steps[8];
+        quint8 count;
+    };
+
+    // === 非直线棋子（按颜色区分的表以 PieceColor 索引） ===
+
+    static const StepList &kingSteps(PieceColor color, int square) { return s_tables.king[side(color)][square]; }
+    static const StepList &advisorSteps(PieceColor color, int square) { return s_tables.advisor[side(color)][square]; }
+    static const StepList &elephantSteps(PieceColor color, int square) { return s_tables.elephant[side(color)][square]; }
+    static const StepList &horseSteps(int square) { return s_tables.horse[square]; }
+    static const StepList &pawnSteps(PieceColor color, int square) { return s_tables.pawn[side(color)][square]; }
+
+    // 能攻击 square 的马所在格（block 为该马的马腿）
+    static const StepList &horseAttackers(int square) { return s_tables.horseAttackers[square]; }
+
+    // color 方能攻击 square 的兵所在格
+    static const StepList &pawnAttackers(PieceColor color, int square) { return s_tables.pawnAttackers[side(color)][square]; }
+
+    // === 直线棋子（行内以列为位，列内以行为位） ===
+
+    // 车：沿行/列可到达的位（包含每个方向第一个阻挡子）
+    static quint16 rankRookTargets(int col, quint16 rankOcc) { return s_tables.rankRook[col][rankOcc]; }
+    static quint16 fileRookTargets(int row, quint16 fileOcc) { return s_tables.fileRook[row][fileOcc]; }
+
+    // 炮：隔一个炮架可吃到的位（不吃子的走法与车的空位相同）
+    static quint16 rankCannonCaptures(int col, quint16 rankOcc) { return s_tables.rankCannon[col][rankOcc]; }
+    static quint16 fileCannonCaptures(int row, quint16 fileOcc) { return s_tables.fileCannon[row][fileOcc]; }
+
+private:
+    static int side(PieceColor color) { return color == PieceColor::Black ? 1 : 0; }
+
+    struct Tables {
+        StepList king[2][SQUARES];
+        StepList advisor[2][SQUARES];
+        StepList elephant[2][SQUARES];
+        StepList horse[SQUARES];
+        StepList pawn[2][SQUARES];
+        StepList horseAttackers[SQUARES];
+        StepList pawnAttackers[2][SQUARES];
+        quint16 rankRook[COLS][1 << COLS];
+        quint16 rankCannon[COLS][1 << COLS];
+        quint16 fileRook[ROWS][1 << ROWS];
+        quint16 fileCannon[ROWS][1 << ROWS];
+    };
+
+    static Tables buildTables();
+    static const Tables s_tables;
+};
+
+#endif // BITBOARD_H
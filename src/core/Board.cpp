@@ -1,61 +1,25 @@
 #include "Board.h"
 #include <QDebug>
+#include <cstring>
+#include <type_traits>
 
-Board::Board()
-{
-    clear();
-}
+static_assert(std::is_trivially_copyable_v<Board>, "Board 必须可平凡拷贝（搜索中按值复制）");
+static_assert(Board::ROWS == Bitboard::ROWS && Board::COLS == Bitboard::COLS, "Bitboard 与 Board 尺寸不一致");
 
-// 复制构造函数（深拷贝）
-Board::Board(const Board &other)
+Board::Board()
 {
     clear();
-
-    // 深拷贝所有棋子
-    for (int row = 0; row < ROWS; ++row) {
-        for (int col = 0; col < COLS; ++col) {
-            const ChessPiece *piece = other.pieceAt(row, col);
-            if (piece && piece->isValid()) {
-                // 创建新的智能指针，指向棋子的副本
-                auto newPiece = QSharedPointer<ChessPiece>::create(*piece);
-                m_board[row][col] = newPiece;
-                m_pieces.append(newPiece);
-            }
-        }
-    }
-}
-
-// 赋值操作符（深拷贝）
-Board& Board::operator=(const Board &other)
-{
-    if (this != &other) {
-        clear();
-
-        // 深拷贝所有棋子
-        for (int row = 0; row < ROWS; ++row) {
-            for (int col = 0; col < COLS; ++col) {
-                const ChessPiece *piece = other.pieceAt(row, col);
-                if (piece && piece->isValid()) {
-                    // 创建新的智能指针，指向棋子的副本
-                    auto newPiece = QSharedPointer<ChessPiece>::create(*piece);
-                    m_board[row][col] = newPiece;
-                    m_pieces.append(newPiece);
-                }
-            }
-        }
-    }
-    return *this;
 }
 
 void Board::clear()
 {
-    // 清空棋盘（智能指针自动释放内存）
-    for (int row = 0; row < ROWS; ++row) {
-        for (int col = 0; col < COLS; ++col) {
-            m_board[row][col].reset();  // 或者 = nullptr
-        }
-    }
-    m_pieces.clear();
+    std::memset(m_squares, EMPTY, sizeof(m_squares));
+    std::memset(m_pieceIndex, -1, sizeof(m_pieceIndex));
+    m_pieceCount[0] = m_pieceCount[1] = 0;
+    m_kingSquare[0] = m_kingSquare[1] = -1;
+    std::memset(m_rankOcc, 0, sizeof(m_rankOcc));
+    std::memset(m_fileOcc, 0, sizeof(m_fileOcc));
+    m_colorMask[0] = m_colorMask[1] = BitMask();
 }
 
 void Board::initializeStartPosition()
@@ -105,35 +69,37 @@ void Board::initializeStartPosition()
     addPiece(ChessPiece(PieceType::Rook, PieceColor::Red, 9, 8));
 }
 
-ChessPiece* Board::pieceAt(int row, int col)
+ChessPiece Board::pieceAt(int row, int col) const
 {
     if (!isValidPosition(row, col))
-        return nullptr;
+        return ChessPiece();
 
-    return m_board[row][col].data();  // 返回原始指针
+    quint8 code = m_squares[toSquare(row, col)];
+    if (code == EMPTY)
+        return ChessPiece();
+
+    return ChessPiece(pieceTypeOf(code), pieceColorOf(code), row, col);
 }
 
-const ChessPiece* Board::pieceAt(int row, int col) const
+void Board::setPiece(int row, int col, const ChessPiece &piece)
 {
     if (!isValidPosition(row, col))
-        return nullptr;
+        return;
 
-    return m_board[row][col].data();  // 返回原始指针
+    setPieceCode(row, col, piece.isValid() ? makePieceCode(piece.type(), piece.color()) : EMPTY);
 }
 
-void Board::setPiece(int row, int col, const ChessPiece &piece)
+void Board::setPieceCode(int row, int col, quint8 code)
 {
-    if (!isValidPosition(row, col))
-        return;
+    int square = toSquare(row, col);
 
-    // 移除旧棋子（智能指针自动管理内存）
-    removePiece(row, col);
+    // 移除旧棋子
+    removePieceCode(square);
 
     // 添加新棋子
-    auto newPiece = QSharedPointer<ChessPiece>::create(piece);
-    newPiece->setPosition(row, col);
-    m_board[row][col] = newPiece;
-    m_pieces.append(newPiece);
+    if (code != EMPTY) {
+        addPieceCode(square, code);
+    }
 }
 
 void Board::removePiece(int row, int col)
@@ -141,13 +107,7 @@ void Board::removePiece(int row, int col)
     if (!isValidPosition(row, col))
         return;
 
-    auto piece = m_board[row][col];
-    if (piece) {
-        // 从棋子列表中移除
-        m_pieces.removeOne(piece);
-        // 从棋盘上移除（智能指针自动释放内存）
-        m_board[row][col].reset();
-    }
+    removePieceCode(toSquare(row, col));
 }
 
 bool Board::movePiece(int fromRow, int fromCol, int toRow, int toCol)
@@ -155,21 +115,36 @@ bool Board::movePiece(int fromRow, int fromCol, int toRow, int toCol)
     if (!isValidPosition(fromRow, fromCol) || !isValidPosition(toRow, toCol))
         return false;
 
-    auto piece = m_board[fromRow][fromCol];
-    if (!piece || !piece->isValid())
+    int fromSquare = toSquare(fromRow, fromCol);
+    int toSq = toSquare(toRow, toCol);
+    if (m_squares[fromSquare] == EMPTY || fromSquare == toSq)
         return false;
 
     // 移除目标位置的棋子（吃子）
-    removePiece(toRow, toCol);
+    removePieceCode(toSq);
 
     // 移动棋子
-    piece->setPosition(toRow, toCol);
-    m_board[toRow][toCol] = piece;
-    m_board[fromRow][fromCol].reset();  // 清空原位置
+    relocatePiece(fromSquare, toSq);
 
     return true;
 }
 
+quint8 Board::makeMove(int fromSq, int toSq)
+{
+    quint8 captured = m_squares[toSq];
+    removePieceCode(toSq);
+    relocatePiece(fromSq, toSq);
+    return captured;
+}
+
+void Board::unmakeMove(int fromSq, int toSq, quint8 captured)
+{
+    relocatePiece(toSq, fromSq);
+    if (captured != EMPTY) {
+        addPieceCode(toSq, captured);
+    }
+}
+
 bool Board::isValidPosition(int row, int col)
 {
     return row >= 0 && row < ROWS && col >= 0 && col < COLS;
@@ -207,37 +182,27 @@ bool Board::isInOwnHalf(int row, int col, PieceColor color)
 
 QList<ChessPiece> Board::getAllPieces() const
 {
-    // 从智能指针列表中提取棋子对象
+    // 按格子顺序（从黑方底线到红方底线）生成棋子对象
     QList<ChessPiece> pieces;
-    for (const auto &piecePtr : m_pieces) {
-        if (piecePtr && piecePtr->isValid()) {
-            pieces.append(*piecePtr);
+    pieces.reserve(m_pieceCount[0] + m_pieceCount[1]);
+    for (int square = 0; square < SQUARES; ++square) {
+        quint8 code = m_squares[square];
+        if (code != EMPTY) {
+            pieces.append(ChessPiece(pieceTypeOf(code), pieceColorOf(code), squareRow(square), squareCol(square)));
         }
     }
     return pieces;
 }
 
-ChessPiece* Board::findKing(PieceColor color)
-{
-    for (auto &piecePtr : m_pieces) {
-        if (piecePtr && piecePtr->isValid() &&
-            piecePtr->type() == PieceType::King &&
-            piecePtr->color() == color) {
-            return piecePtr.data();  // 返回原始指针
-        }
-    }
-    return nullptr;
-}
-
 void Board::print() const
 {
     qDebug() << "=== 棋盘 ===";
     for (int row = 0; row < ROWS; ++row) {
         QString line;
         for (int col = 0; col < COLS; ++col) {
-            const ChessPiece *piece = pieceAt(row, col);
-            if (piece) {
-                line += piece->chineseName() + " ";
+            ChessPiece piece = pieceAt(row, col);
+            if (piece.isValid()) {
+                line += piece.chineseName() + " ";
             } else {
                 line += "·  ";
             }
@@ -249,7 +214,75 @@ void Board::print() const
 
 void Board::addPiece(const ChessPiece &piece)
 {
-    auto piecePtr = QSharedPointer<ChessPiece>::create(piece);
-    m_pieces.append(piecePtr);
-    m_board[piece.row()][piece.col()] = piecePtr;
+    addPieceCode(toSquare(piece.row(), piece.col()), makePieceCode(piece.type(), piece.color()));
+}
+
+void Board::addPieceCode(int square, quint8 code)
+{
+    int side = (code & BLACK_FLAG) ? 1 : 0;
+    if (m_pieceCount[side] >= MAX_SIDE_PIECES)
+        return;  // 非法局面（棋子过多），忽略
+
+    int index = m_pieceCount[side]++;
+    m_pieceList[side][index] = static_cast<quint8>(square);
+    m_pieceIndex[square] = static_cast<qint8>(index);
+    m_squares[square] = code;
+    toggleOccupancy(square, side);
+
+    if (pieceTypeOf(code) == PieceType::King) {
+        m_kingSquare[side] = static_cast<qint8>(square);
+    }
+}
+
+void Board::removePieceCode(int square)
+{
+    quint8 code = m_squares[square];
+    if (code == EMPTY)
+        return;
+
+    // 用列表最后一个棋子填补空位
+    int side = (code & BLACK_FLAG) ? 1 : 0;
+    int index = m_pieceIndex[square];
+    int lastSquare = m_pieceList[side][--m_pieceCount[side]];
+    m_pieceList[side][index] = static_cast<quint8>(lastSquare);
+    m_pieceIndex[lastSquare] = static_cast<qint8>(index);
+
+    m_pieceIndex[square] = -1;
+    m_squares[square] = EMPTY;
+    toggleOccupancy(square, side);
+
+    if (pieceTypeOf(code) == PieceType::King) {
+        m_kingSquare[side] = -1;
+    }
+}
+
+void Board::relocatePiece(int fromSq, int toSq)
+{
+    quint8 code = m_squares[fromSq];
+    int side = (code & BLACK_FLAG) ? 1 : 0;
+    int index = m_pieceIndex[fromSq];
+
+    m_squares[toSq] = code;
+    m_squares[fromSq] = EMPTY;
+    m_pieceList[side][index] = static_cast<quint8>(toSq);
+    m_pieceIndex[toSq] = static_cast<qint8>(index);
+    m_pieceIndex[fromSq] = -1;
+    toggleOccupancy(fromSq, side);
+    toggleOccupancy(toSq, side);
+
+    if (pieceTypeOf(code) == PieceType::King) {
+        m_kingSquare[side] = static_cast<qint8>(toSq);
+    }
+}
+
+void Board::toggleOccupancy(int square, int side)
+{
+    int row = squareRow(square);
+    int col = squareCol(square);
+    m_rankOcc[row] ^= quint16(1 << col);
+    m_fileOcc[col] ^= quint16(1 << row);
+
+    BitMask bit;
+    bit.set(square);
+    m_colorMask[side] ^= bit;
 }
@@ -2,25 +2,32 @@
 #define BOARD_H
 
 #include "ChessPiece.h"
-#include <QVector>
+#include "Bitboard.h"
 #include <QList>
 #include <QString>
-#include <QSharedPointer>
+#include <QtTypes>
 
 // 棋盘类 - 9×10 格位
+//
+// 内部使用紧凑的值类型表示：90 字节的格子数组保存棋子编码，
+// 另有按颜色划分的棋子列表（保存棋子所在格子），便于快速遍历。
+// 整个对象可平凡拷贝，搜索中复制棋盘不会产生任何堆分配。
+// 同时维护每行/每列的占用位与双方的 90 位占用掩码，供 Bitboard 查表生成走法。
 class Board
 {
 public:
     static const int ROWS = 10;    // 10条横线（0-9）
     static const int COLS = 9;     // 9条竖线（0-8）
+    static const int SQUARES = ROWS * COLS;  // 格子总数（90）
 
-    Board();
+    // 棋子编码：0 表示空位，低3位为 PieceType，BLACK_FLAG 位表示黑方
+    static const quint8 EMPTY = 0;
+    static const quint8 BLACK_FLAG = 8;
 
-    // 复制构造函数（深拷贝）
-    Board(const Board &other);
+    // 每方最多棋子数
+    static const int MAX_SIDE_PIECES = 16;
 
-    // 赋值操作符（深拷贝）
-    Board& operator=(const Board &other);
+    Board();
 
     // 初始化棋盘到初始局面
     void initializeStartPosition();
@@ -28,9 +35,8 @@ public:
     // 清空棋盘
     void clear();
 
-    // 获取指定位置的棋子（返回指针，nullptr 表示空位）
-    ChessPiece* pieceAt(int row, int col);
-    const ChessPiece* pieceAt(int row, int col) const;
+    // 获取指定位置的棋子（值语义，空位或越界返回无效棋子）
+    ChessPiece pieceAt(int row, int col) const;
 
     // 设置指定位置的棋子
     void setPiece(int row, int col, const ChessPiece &piece);
@@ -41,6 +47,58 @@ public:
     // 移动棋子（会自动处理吃子）
     bool movePiece(int fromRow, int fromCol, int toRow, int toCol);
 
+    // === 紧凑编码访问（搜索热路径使用，调用方需保证坐标有效） ===
+
+    quint8 pieceCode(int row, int col) const { return m_squares[row * COLS + col]; }
+    quint8 pieceCodeAt(int square) const { return m_squares[square]; }
+    bool isEmpty(int row, int col) const { return m_squares[row * COLS + col] == EMPTY; }
+
+    // 直接设置格子上的棋子编码（EMPTY 表示清空）
+    void setPieceCode(int row, int col, quint8 code);
+
+    // 按格子下标走子，返回被吃棋子编码（不做合法性检查，供 Position::makeMove 使用）
+    quint8 makeMove(int fromSq, int toSq);
+
+    // 撤销 makeMove：棋子移回原处并恢复被吃的棋子
+    void unmakeMove(int fromSq, int toSq, quint8 captured);
+
+    // 编码与类型/颜色之间的转换
+    static quint8 makePieceCode(PieceType type, PieceColor color) {
+        return static_cast<quint8>(static_cast<int>(type) | (color == PieceColor::Black ? BLACK_FLAG : 0));
+    }
+    static PieceType pieceTypeOf(quint8 code) { return static_cast<PieceType>(code & 7); }
+    static PieceColor pieceColorOf(quint8 code) {
+        return code == EMPTY ? PieceColor::None : ((code & BLACK_FLAG) ? PieceColor::Black : PieceColor::Red);
+    }
+
+    // 格子下标与行列的转换
+    static int toSquare(int row, int col) { return row * COLS + col; }
+    static int squareRow(int square) { return square / COLS; }
+    static int squareCol(int square) { return square % COLS; }
+
+    // === 棋子列表 ===
+
+    // 指定颜色的棋子数量
+    int pieceCount(PieceColor color) const { return m_pieceCount[sideIndex(color)]; }
+
+    // 指定颜色第 index 个棋子所在格子
+    int pieceSquare(PieceColor color, int index) const { return m_pieceList[sideIndex(color)][index]; }
+
+    // 将/帅所在格子（-1 表示不存在）
+    int kingSquare(PieceColor color) const { return m_kingSquare[sideIndex(color)]; }
+
+    // === 占用信息（位表示） ===
+
+    // 第 row 行的占用位（第 col 位表示第 col 列有子）
+    quint16 rankOccupancy(int row) const { return m_rankOcc[row]; }
+
+    // 第 col 列的占用位（第 row 位表示第 row 行有子）
+    quint16 fileOccupancy(int col) const { return m_fileOcc[col]; }
+
+    // 指定颜色棋子的占用掩码 / 全部棋子的占用掩码
+    const BitMask &colorMask(PieceColor color) const { return m_colorMask[sideIndex(color)]; }
+    BitMask occupancy() const { return m_colorMask[0] | m_colorMask[1]; }
+
     // 检查坐标是否有效
     static bool isValidPosition(int row, int col);
 
@@ -50,24 +108,34 @@ public:
     // 检查位置是否在己方半场
     static bool isInOwnHalf(int row, int col, PieceColor color);
 
-    // 获取所有棋子列表
+    // 获取所有棋子列表（供 QML 模型等使用）
     QList<ChessPiece> getAllPieces() const;
 
-    // 查找指定类型和颜色的棋子
-    ChessPiece* findKing(PieceColor color);
-
     // 调试：打印棋盘
     void print() const;
 
 private:
-    // 二维数组存储棋盘，使用智能指针管理棋子
-    QSharedPointer<ChessPiece> m_board[ROWS][COLS];
+    static int sideIndex(PieceColor color) { return color == PieceColor::Black ? 1 : 0; }
 
-    // 棋子池（实际存储棋子对象的智能指针）
-    QList<QSharedPointer<ChessPiece>> m_pieces;
+    // 辅助函数：切换格子的占用位
+    void toggleOccupancy(int square, int side);
+
+    // 辅助函数：在空格子上放置棋子 / 移除格子上的棋子 / 把棋子移到空格子
+    void addPieceCode(int square, quint8 code);
+    void removePieceCode(int square);
+    void relocatePiece(int fromSq, int toSq);
 
     // 辅助函数：添加棋子到棋盘
     void addPiece(const ChessPiece &piece);
+
+    quint8 m_squares[SQUARES];                        // 每个格子上的棋子编码
+    qint8 m_pieceIndex[SQUARES];                      // 格子上棋子在棋子列表中的下标（-1 表示空）
+    quint8 m_pieceList[2][MAX_SIDE_PIECES];           // 按颜色划分的棋子所在格子
+    quint8 m_pieceCount[2];                           // 每方棋子数量
+    qint8 m_kingSquare[2];                            // 双方将帅所在格子
+    quint16 m_rankOcc[ROWS];                          // 每行占用位
+    quint16 m_fileOcc[COLS];                          // 每列占用位
+    BitMask m_colorMask[2];                           // 双方占用掩码
 };
 
 #endif // BOARD_H
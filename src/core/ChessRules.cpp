@@ -1,6 +1,5 @@
 #include "ChessRules.h"
 #include <QDebug>
-#include <cmath>
 
 bool ChessRules::isValidMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol)
 {
@@ -9,302 +8,344 @@ bool ChessRules::isValidMove(const Board &board, int fromRow, int fromCol, int t
         return false;
 
     // 起点必须有棋子
-    const ChessPiece *piece = board.pieceAt(fromRow, fromCol);
-    if (!piece || !piece->isValid())
+    if (board.isEmpty(fromRow, fromCol))
         return false;
 
-    // 不能移动到原位置
-    if (fromRow == toRow && fromCol == toCol)
-        return false;
-
-    // 不能吃自己的棋子
-    const ChessPiece *targetPiece = board.pieceAt(toRow, toCol);
-    if (targetPiece && targetPiece->isValid() && piece->isSameColor(*targetPiece))
-        return false;
+    return pseudoTargets(board, Board::toSquare(fromRow, fromCol)).test(Board::toSquare(toRow, toCol));
+}
 
-    // 根据棋子类型检查移动规则
-    switch (piece->type()) {
-    case PieceType::King:
-        return isValidKingMove(board, fromRow, fromCol, toRow, toCol, piece->color());
-    case PieceType::Advisor:
-        return isValidAdvisorMove(board, fromRow, fromCol, toRow, toCol, piece->color());
-    case PieceType::Elephant:
-        return isValidElephantMove(board, fromRow, fromCol, toRow, toCol, piece->color());
-    case PieceType::Horse:
-        return isValidHorseMove(board, fromRow, fromCol, toRow, toCol);
-    case PieceType::Rook:
-        return isValidRookMove(board, fromRow, fromCol, toRow, toCol);
-    case PieceType::Cannon:
-        return isValidCannonMove(board, fromRow, fromCol, toRow, toCol);
-    case PieceType::Pawn:
-        return isValidPawnMove(board, fromRow, fromCol, toRow, toCol, piece->color());
-    default:
-        return false;
+void ChessRules::addRankBits(BitMask &mask, int row, quint16 bits)
+{
+    while (bits) {
+        int col = std::countr_zero(bits);
+        bits &= bits - 1;
+        mask.set(row * Board::COLS + col);
     }
 }
 
-// 将/帅：只能在九宫内移动，每次一步，不能斜走
-bool ChessRules::isValidKingMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color)
+void ChessRules::addFileBits(BitMask &mask, int col, quint16 bits)
 {
-    // 必须在九宫内
-    if (!Board::isInPalace(toRow, toCol, color))
-        return false;
-
-    // 只能移动一格
-    int rowDiff = std::abs(toRow - fromRow);
-    int colDiff = std::abs(toCol - fromCol);
-
-    // 只能直走（不能斜走）
-    if ((rowDiff == 1 && colDiff == 0) || (rowDiff == 0 && colDiff == 1))
-        return true;
+    while (bits) {
+        int row = std::countr_zero(bits);
+        bits &= bits - 1;
+        mask.set(row * Board::COLS + col);
+    }
+}
 
-    // 特殊规则：飞将（将帅对面）
-    const ChessPiece *targetPiece = board.pieceAt(toRow, toCol);
-    if (targetPiece && targetPiece->type() == PieceType::King) {
-        // 检查是否在同一列且中间无棋子
-        if (fromCol == toCol && isPathClear(board, fromRow, fromCol, toRow, toCol)) {
-            return true;
+void ChessRules::addSteps(BitMask &mask, const Board &board, const Bitboard::StepList &steps)
+{
+    for (int i = 0; i < steps.count; ++i) {
+        const Bitboard::Step &step = steps.steps[i];
+        if (step.block < 0 || board.pieceCodeAt(step.block) == Board::EMPTY) {
+            mask.set(step.to);
         }
     }
-
-    return false;
 }
 
-// 士/仕：只能在九宫内斜走，每次一步
-bool ChessRules::isValidAdvisorMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color)
+BitMask ChessRules::pseudoTargets(const Board &board, int square)
 {
-    // 必须在九宫内
-    if (!Board::isInPalace(toRow, toCol, color))
-        return false;
-
-    // 只能斜走一格
-    int rowDiff = std::abs(toRow - fromRow);
-    int colDiff = std::abs(toCol - fromCol);
+    quint8 piece = board.pieceCodeAt(square);
+    if (piece == Board::EMPTY)
+        return BitMask();
+
+    BitMask targets = attackTargets(board, square);
+
+    // 炮：不吃子时同车的空位
+    if (Board::pieceTypeOf(piece) == PieceType::Cannon) {
+        int row = Board::squareRow(square);
+        int col = Board::squareCol(square);
+        quint16 rankOcc = board.rankOccupancy(row);
+        quint16 fileOcc = board.fileOccupancy(col);
+        addRankBits(targets, row, Bitboard::rankRookTargets(col, rankOcc) & ~rankOcc);
+        addFileBits(targets, col, Bitboard::fileRookTargets(row, fileOcc) & ~fileOcc);
+    }
 
-    return rowDiff == 1 && colDiff == 1;
+    // 不能吃自己的棋子
+    return targets & ~board.colorMask(Board::pieceColorOf(piece));
 }
 
-// 象/相：只能在己方半场斜走，每次两格，不能越子（塞象眼）
-bool ChessRules::isValidElephantMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color)
+BitMask ChessRules::attackTargets(const Board &board, int square)
 {
-    // 必须在己方半场
-    if (!Board::isInOwnHalf(toRow, toCol, color))
-        return false;
-
-    // 必须斜走两格
-    int rowDiff = toRow - fromRow;
-    int colDiff = toCol - fromCol;
+    BitMask targets;
+    quint8 piece = board.pieceCodeAt(square);
+    if (piece == Board::EMPTY)
+        return targets;
 
-    if (std::abs(rowDiff) != 2 || std::abs(colDiff) != 2)
-        return false;
+    PieceColor color = Board::pieceColorOf(piece);
+    int row = Board::squareRow(square);
+    int col = Board::squareCol(square);
 
-    // 检查象眼是否被塞
-    int eyeRow = fromRow + rowDiff / 2;
-    int eyeCol = fromCol + colDiff / 2;
-    const ChessPiece *eyePiece = board.pieceAt(eyeRow, eyeCol);
+    switch (Board::pieceTypeOf(piece)) {
+    case PieceType::King:
+        // 将/帅：九宫内直走一步
+        addSteps(targets, board, Bitboard::kingSteps(color, square));
+        break;
+    case PieceType::Advisor:
+        // 士/仕：九宫内斜走一步
+        addSteps(targets, board, Bitboard::advisorSteps(color, square));
+        break;
+    case PieceType::Elephant:
+        // 象/相：己方半场斜走两格，塞象眼不能走
+        addSteps(targets, board, Bitboard::elephantSteps(color, square));
+        break;
+    case PieceType::Horse:
+        // 马：走日字，蹩马腿不能走
+        addSteps(targets, board, Bitboard::horseSteps(square));
+        break;
+    case PieceType::Pawn:
+        // 兵/卒：过河前只能前进，过河后可以左右移动
+        addSteps(targets, board, Bitboard::pawnSteps(color, square));
+        break;
+    case PieceType::Rook: {
+        // 车：横竖直走到第一个阻挡子为止
+        addRankBits(targets, row, Bitboard::rankRookTargets(col, board.rankOccupancy(row)));
+        addFileBits(targets, col, Bitboard::fileRookTargets(row, board.fileOccupancy(col)));
+        break;
+    }
+    case PieceType::Cannon:
+        // 炮：隔一个炮架
+        addRankBits(targets, row, Bitboard::rankCannonCaptures(col, board.rankOccupancy(row)));
+        addFileBits(targets, col, Bitboard::fileCannonCaptures(row, board.fileOccupancy(col)));
+        break;
+    default:
+        break;
+    }
 
-    return !eyePiece || !eyePiece->isValid();
+    return targets;
 }
 
-// 马：走日字，不能蹩马腿
-bool ChessRules::isValidHorseMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol)
+void ChessRules::generatePseudoLegalMoves(const Board &board, PieceColor color, MoveList &moves, MoveGenType type)
 {
-    int rowDiff = std::abs(toRow - fromRow);
-    int colDiff = std::abs(toCol - fromCol);
-
-    // 必须走日字（2+1 或 1+2）
-    if (!((rowDiff == 2 && colDiff == 1) || (rowDiff == 1 && colDiff == 2)))
-        return false;
-
-    // 检查马腿
-    int legRow = fromRow;
-    int legCol = fromCol;
+    PieceColor enemy = (color == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+
+    int count = board.pieceCount(color);
+    for (int i = 0; i < count; ++i) {
+        int fromSq = board.pieceSquare(color, i);
+        BitMask targets = pseudoTargets(board, fromSq);
+        if (type == MoveGenType::Captures) {
+            targets &= board.colorMask(enemy);
+        } else if (type == MoveGenType::Quiets) {
+            targets &= ~board.occupancy();
+        }
 
-    if (rowDiff == 2) {
-        legRow += (toRow > fromRow) ? 1 : -1;
-    } else {
-        legCol += (toCol > fromCol) ? 1 : -1;
+        int fromRow = Board::squareRow(fromSq);
+        int fromCol = Board::squareCol(fromSq);
+        while (!targets.isEmpty()) {
+            int toSq = targets.popLowest();
+            moves.append(AIMove(fromRow, fromCol, Board::squareRow(toSq), Board::squareCol(toSq)));
+        }
     }
-
-    const ChessPiece *legPiece = board.pieceAt(legRow, legCol);
-    return !legPiece || !legPiece->isValid();
 }
 
-// 车/車：横竖直走，路径不能有棋子
-bool ChessRules::isValidRookMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol)
+bool ChessRules::isPseudoLegal(const Board &board, PieceColor color, const AIMove &move)
 {
-    // 必须直线移动
-    if (fromRow != toRow && fromCol != toCol)
+    if (!move.isValid())
         return false;
 
-    // 路径必须畅通
-    return isPathClear(board, fromRow, fromCol, toRow, toCol);
+    int fromSq = Board::toSquare(move.fromRow, move.fromCol);
+    quint8 piece = board.pieceCodeAt(fromSq);
+    if (piece == Board::EMPTY || Board::pieceColorOf(piece) != color)
+        return false;
+
+    return pseudoTargets(board, fromSq).test(Board::toSquare(move.toRow, move.toCol));
 }
 
-// 炮：横竖直走，吃子时中间必须有且仅有一个棋子（炮架）
-bool ChessRules::isValidCannonMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol)
+bool ChessRules::isSquareAttacked(const Board &board, int square, PieceColor byColor)
 {
-    // 必须直线移动
-    if (fromRow != toRow && fromCol != toCol)
-        return false;
+    return !collectAttackers(board, square, byColor, true).isEmpty();
+}
 
-    const ChessPiece *targetPiece = board.pieceAt(toRow, toCol);
-    int piecesBetween = countPiecesBetween(board, fromRow, fromCol, toRow, toCol);
+BitMask ChessRules::attackersTo(const Board &board, int square, PieceColor byColor)
+{
+    return collectAttackers(board, square, byColor, false);
+}
 
-    // 不吃子：路径必须畅通
-    if (!targetPiece || !targetPiece->isValid()) {
-        return piecesBetween == 0;
+BitMask ChessRules::collectAttackers(const Board &board, int square, PieceColor byColor, bool stopAtFirst)
+{
+    BitMask attackers;
+    int row = Board::squareRow(square);
+    int col = Board::squareCol(square);
+    quint16 rankOcc = board.rankOccupancy(row);
+    quint16 fileOcc = board.fileOccupancy(col);
+
+    // 记录一个攻击者；只需判断是否受攻击时找到第一个就返回
+    auto found = [&](int from) {
+        attackers.set(from);
+        return stopAtFirst;
+    };
+
+    const quint8 rook = Board::makePieceCode(PieceType::Rook, byColor);
+    const quint8 cannon = Board::makePieceCode(PieceType::Cannon, byColor);
+    const quint8 horse = Board::makePieceCode(PieceType::Horse, byColor);
+    const quint8 pawn = Board::makePieceCode(PieceType::Pawn, byColor);
+
+    // 车：行/列上的第一个棋子
+    quint16 bits = Bitboard::rankRookTargets(col, rankOcc) & rankOcc;
+    while (bits) {
+        int c = std::countr_zero(bits);
+        bits &= bits - 1;
+        if (board.pieceCode(row, c) == rook && found(Board::toSquare(row, c))) return attackers;
     }
-    // 吃子：中间必须有且仅有一个棋子
-    else {
-        return piecesBetween == 1;
+    bits = Bitboard::fileRookTargets(row, fileOcc) & fileOcc;
+    while (bits) {
+        int r = std::countr_zero(bits);
+        bits &= bits - 1;
+        if (board.pieceCode(r, col) == rook && found(Board::toSquare(r, col))) return attackers;
     }
-}
 
-// 兵/卒：过河前只能前进，过河后可以左右移动
-bool ChessRules::isValidPawnMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color)
-{
-    int rowDiff = toRow - fromRow;
-    int colDiff = std::abs(toCol - fromCol);
+    // 炮：隔一个炮架的棋子
+    bits = Bitboard::rankCannonCaptures(col, rankOcc);
+    while (bits) {
+        int c = std::countr_zero(bits);
+        bits &= bits - 1;
+        if (board.pieceCode(row, c) == cannon && found(Board::toSquare(row, c))) return attackers;
+    }
+    bits = Bitboard::fileCannonCaptures(row, fileOcc);
+    while (bits) {
+        int r = std::countr_zero(bits);
+        bits &= bits - 1;
+        if (board.pieceCode(r, col) == cannon && found(Board::toSquare(r, col))) return attackers;
+    }
 
-    // 只能移动一格
-    if (std::abs(rowDiff) + colDiff != 1)
-        return false;
+    // 马：马腿紧邻马所在格
+    const Bitboard::StepList &horses = Bitboard::horseAttackers(square);
+    for (int i = 0; i < horses.count; ++i) {
+        if (board.pieceCodeAt(horses.steps[i].to) == horse
+            && board.pieceCodeAt(horses.steps[i].block) == Board::EMPTY
+            && found(horses.steps[i].to)) {
+            return attackers;
+        }
+    }
 
-    // 红方向上走（row减小），黑方向下走（row增大）
-    bool isForward = (color == PieceColor::Red && rowDiff < 0) ||
-                     (color == PieceColor::Black && rowDiff > 0);
+    // 兵/卒
+    const Bitboard::StepList &pawns = Bitboard::pawnAttackers(byColor, square);
+    for (int i = 0; i < pawns.count; ++i) {
+        if (board.pieceCodeAt(pawns.steps[i].to) == pawn && found(pawns.steps[i].to)) return attackers;
+    }
 
-    // 判断是否过河
-    bool hasCrossedRiver = !Board::isInOwnHalf(fromRow, fromCol, color);
+    // 将、士、象只能攻击己方九宫/半场内的格子（走法对称，按目标格反查）
+    const quint8 king = Board::makePieceCode(PieceType::King, byColor);
+    const quint8 advisor = Board::makePieceCode(PieceType::Advisor, byColor);
+    const quint8 elephant = Board::makePieceCode(PieceType::Elephant, byColor);
 
-    // 过河前只能前进
-    if (!hasCrossedRiver) {
-        return isForward && colDiff == 0;
+    const Bitboard::StepList &kings = Bitboard::kingSteps(byColor, square);
+    for (int i = 0; i < kings.count; ++i) {
+        if (board.pieceCodeAt(kings.steps[i].to) == king && found(kings.steps[i].to)) return attackers;
     }
-    // 过河后可以前进或左右移动
-    else {
-        return (isForward && colDiff == 0) || (rowDiff == 0 && colDiff == 1);
+    const Bitboard::StepList &advisors = Bitboard::advisorSteps(byColor, square);
+    for (int i = 0; i < advisors.count; ++i) {
+        if (board.pieceCodeAt(advisors.steps[i].to) == advisor && found(advisors.steps[i].to)) return attackers;
+    }
+    const Bitboard::StepList &elephants = Bitboard::elephantSteps(byColor, square);
+    for (int i = 0; i < elephants.count; ++i) {
+        if (board.pieceCodeAt(elephants.steps[i].to) == elephant
+            && board.pieceCodeAt(elephants.steps[i].block) == Board::EMPTY
+            && found(elephants.steps[i].to)) {
+            return attackers;
+        }
     }
-}
 
-// 检查路径是否畅通（不包括起点和终点）
-bool ChessRules::isPathClear(const Board &board, int fromRow, int fromCol, int toRow, int toCol)
-{
-    return countPiecesBetween(board, fromRow, fromCol, toRow, toCol) == 0;
+    return attackers;
 }
 
-// 计算路径上的棋子数量（不包括起点和终点）
-int ChessRules::countPiecesBetween(const Board &board, int fromRow, int fromCol, int toRow, int toCol)
+bool ChessRules::isKingsFacing(const Board &board)
 {
-    int count = 0;
-
-    // 确定移动方向
-    int rowStep = (toRow == fromRow) ? 0 : ((toRow > fromRow) ? 1 : -1);
-    int colStep = (toCol == fromCol) ? 0 : ((toCol > fromCol) ? 1 : -1);
-
-    int currentRow = fromRow + rowStep;
-    int currentCol = fromCol + colStep;
+    int redKing = board.kingSquare(PieceColor::Red);
+    int blackKing = board.kingSquare(PieceColor::Black);
+    if (redKing < 0 || blackKing < 0)
+        return false;
 
-    // 遍历路径（不包括终点）
-    while (currentRow != toRow || currentCol != toCol) {
-        const ChessPiece *piece = board.pieceAt(currentRow, currentCol);
-        if (piece && piece->isValid()) {
-            ++count;
-        }
-        currentRow += rowStep;
-        currentCol += colStep;
-    }
+    int col = Board::squareCol(redKing);
+    if (Board::squareCol(blackKing) != col)
+        return false;
 
-    return count;
+    // 从红帅向上看到的第一个棋子是黑将即为照面
+    quint16 fileOcc = board.fileOccupancy(col);
+    quint16 blockers = Bitboard::fileRookTargets(Board::squareRow(redKing), fileOcc) & fileOcc;
+    return (blockers >> Board::squareRow(blackKing)) & 1;
 }
 
 bool ChessRules::isInCheck(const Board &board, PieceColor kingColor)
 {
     // 找到己方将/帅
-    ChessPiece *king = const_cast<Board&>(board).findKing(kingColor);
-    if (!king)
+    int kingSquare = board.kingSquare(kingColor);
+    if (kingSquare < 0)
         return false;
 
-    int kingRow = king->row();
-    int kingCol = king->col();
-
-    // 检查是否有对方棋子可以吃掉将/帅
-    QList<ChessPiece> allPieces = board.getAllPieces();
-    for (const ChessPiece &piece : allPieces) {
-        if (piece.color() != kingColor) {
-            if (isValidMove(board, piece.row(), piece.col(), kingRow, kingCol)) {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    PieceColor attackColor = (kingColor == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+    return isSquareAttacked(board, kingSquare, attackColor) || isKingsFacing(board);
 }
 
 bool ChessRules::wouldBeInCheck(Board &board, int fromRow, int fromCol, int toRow, int toCol)
 {
-    const ChessPiece *movingPiece = board.pieceAt(fromRow, fromCol);
-    if (!movingPiece)
+    quint8 movingPiece = board.pieceCode(fromRow, fromCol);
+    if (movingPiece == Board::EMPTY)
         return true;
 
-    PieceColor color = movingPiece->color();
+    PieceColor color = Board::pieceColorOf(movingPiece);
+    int fromSq = Board::toSquare(fromRow, fromCol);
+    int toSq = Board::toSquare(toRow, toCol);
 
-    // 保存目标位置的棋子
-    ChessPiece *targetPiece = board.pieceAt(toRow, toCol);
-    ChessPiece savedTarget;
-    if (targetPiece) {
-        savedTarget = *targetPiece;
-    }
-
-    // 临时移动
-    board.movePiece(fromRow, fromCol, toRow, toCol);
-
-    // 检查是否被将军
+    // 临时移动，检查后恢复
+    quint8 captured = board.makeMove(fromSq, toSq);
     bool inCheck = isInCheck(board, color);
-
-    // 恢复棋盘
-    board.movePiece(toRow, toCol, fromRow, fromCol);
-    if (savedTarget.isValid()) {
-        board.setPiece(toRow, toCol, savedTarget);
-    }
+    board.unmakeMove(fromSq, toSq, captured);
 
     return inCheck;
 }
 
 QList<QPoint> ChessRules::getLegalMoves(const Board &board, int row, int col)
 {
+    MoveList legalMoves;
+    getLegalMoves(board, row, col, legalMoves);
+
     QList<QPoint> moves;
+    moves.reserve(legalMoves.size());
+    for (const AIMove &move : legalMoves) {
+        moves.append(QPoint(move.toCol, move.toRow));
+    }
+    return moves;
+}
 
-    const ChessPiece *piece = board.pieceAt(row, col);
-    if (!piece || !piece->isValid())
-        return moves;
-
-    // 遍历棋盘所有位置
-    for (int toRow = 0; toRow < Board::ROWS; ++toRow) {
-        for (int toCol = 0; toCol < Board::COLS; ++toCol) {
-            if (isValidMove(board, row, col, toRow, toCol)) {
-                // 还需要检查是否会导致自己被将军
-                Board tempBoard = board;
-                if (!wouldBeInCheck(tempBoard, row, col, toRow, toCol)) {
-                    moves.append(QPoint(toCol, toRow));
-                }
-            }
+void ChessRules::getLegalMoves(const Board &board, int row, int col, MoveList &moves)
+{
+    if (!Board::isValidPosition(row, col) || board.isEmpty(row, col))
+        return;
+
+    int fromSq = Board::toSquare(row, col);
+    PieceColor color = Board::pieceColorOf(board.pieceCodeAt(fromSq));
+    BitMask targets = pseudoTargets(board, fromSq);
+    Board tempBoard = board;
+
+    while (!targets.isEmpty()) {
+        int toSq = targets.popLowest();
+
+        // 还需要检查是否会导致自己被将军
+        quint8 captured = tempBoard.makeMove(fromSq, toSq);
+        if (!isInCheck(tempBoard, color)) {
+            moves.append(AIMove(row, col, Board::squareRow(toSq), Board::squareCol(toSq)));
         }
+        tempBoard.unmakeMove(fromSq, toSq, captured);
     }
-
-    return moves;
 }
 
 bool ChessRules::hasLegalMoves(const Board &board, PieceColor color)
 {
+    Board tempBoard = board;
+
     // 遍历所有己方棋子
-    QList<ChessPiece> allPieces = board.getAllPieces();
-    for (const ChessPiece &piece : allPieces) {
-        if (piece.color() == color) {
-            // 检查这个棋子是否有合法走法
-            QList<QPoint> moves = getLegalMoves(board, piece.row(), piece.col());
-            if (!moves.isEmpty()) {
+    int count = board.pieceCount(color);
+    for (int i = 0; i < count; ++i) {
+        int fromSq = board.pieceSquare(color, i);
+        BitMask targets = pseudoTargets(board, fromSq);
+
+        // 检查这个棋子是否有合法走法
+        while (!targets.isEmpty()) {
+            int toSq = targets.popLowest();
+            quint8 captured = tempBoard.makeMove(fromSq, toSq);
+            bool legal = !isInCheck(tempBoard, color);
+            tempBoard.unmakeMove(fromSq, toSq, captured);
+            if (legal) {
                 return true;  // 找到至少一个合法走法
             }
         }
@@ -333,3 +374,96 @@ bool ChessRules::isStalemate(const Board &board, PieceColor currentTurn)
     // 没有被将军，检查是否有合法走法
     return !hasLegalMoves(board, currentTurn);
 }
+
+// 捉子：走动的棋子新攻击到对方一个无根的子，或以小捉大（马、炮捉车等）。
+// 将帅和兵卒捉子、捉未过河的兵卒不算捉；吃子后送将的攻击也不算。
+// 简化：只看走动的棋子本身，不考虑闪击造成的捉子。
+bool ChessRules::isChase(Board &board, int fromSq, int toSq)
+{
+    // 按 PieceType 下标：车 > 马炮 > 士象 > 兵
+    static const int chaseRank[] = {0, 0, 2, 2, 3, 4, 3, 1};
+    static_assert(static_cast<int>(PieceType::Pawn) == 7, "chaseRank 与 PieceType 不一致");
+
+    quint8 chaser = board.pieceCodeAt(toSq);
+    PieceType chaserType = Board::pieceTypeOf(chaser);
+    if (chaserType == PieceType::King || chaserType == PieceType::Pawn) {
+        return false;
+    }
+    PieceColor color = Board::pieceColorOf(chaser);
+    PieceColor enemy = (color == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+
+    // 走子后攻击到、走子前攻击不到的对方棋子
+    BitMask attacked = pseudoTargets(board, toSq) & board.colorMask(enemy);
+    board.unmakeMove(fromSq, toSq, Board::EMPTY);
+    BitMask before = pseudoTargets(board, fromSq);
+    board.makeMove(fromSq, toSq);
+    attacked &= ~before;
+
+    while (!attacked.isEmpty()) {
+        int targetSq = attacked.popLowest();
+        quint8 target = board.pieceCodeAt(targetSq);
+        PieceType targetType = Board::pieceTypeOf(target);
+        if (targetType == PieceType::King) {
+            continue;
+        }
+        if (targetType == PieceType::Pawn && Board::isInOwnHalf(Board::squareRow(targetSq), Board::squareCol(targetSq), enemy)) {
+            continue;
+        }
+
+        // 试吃：送将不算捉；以小捉大总算捉，否则要求被捉的子无根
+        quint8 captured = board.makeMove(toSq, targetSq);
+        bool legal = !isInCheck(board, color);
+        bool chase = legal && (chaseRank[static_cast<int>(targetType)] > chaseRank[static_cast<int>(chaserType)]
+                               || !isSquareAttacked(board, targetSq, enemy));
+        board.unmakeMove(toSq, targetSq, captured);
+
+        if (chase) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RepetitionResult ChessRules::judgeRepetition(const Position &position)
+{
+    int cycle = position.repetitionCycle();
+    if (cycle == 0) {
+        return RepetitionResult::None;
+    }
+
+    // 从当前局面逐步退回循环起点，循环内都是不吃子的走法，退回时无需恢复棋子。
+    // 往前第奇数步是对方走的，第偶数步是己方走的
+    Board board = position.board();
+    bool ourCheck = true, theirCheck = true;
+    bool ourForcing = true, theirForcing = true;
+
+    for (int plies = 1; plies <= cycle; ++plies) {
+        int fromSq, toSq;
+        if (!position.historyMove(plies, fromSq, toSq)) {
+            return RepetitionResult::Draw;
+        }
+
+        PieceColor mover = Board::pieceColorOf(board.pieceCodeAt(toSq));
+        PieceColor opponent = (mover == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+        bool check = isInCheck(board, opponent);
+        bool forcing = check || isChase(board, fromSq, toSq);
+
+        if (plies % 2 == 0) {
+            ourCheck = ourCheck && check;
+            ourForcing = ourForcing && forcing;
+        } else {
+            theirCheck = theirCheck && check;
+            theirForcing = theirForcing && forcing;
+        }
+
+        board.unmakeMove(fromSq, toSq, Board::EMPTY);
+    }
+
+    if (ourCheck != theirCheck) {
+        return ourCheck ? RepetitionResult::Loss : RepetitionResult::Win;
+    }
+    if (!ourCheck && ourForcing != theirForcing) {
+        return ourForcing ? RepetitionResult::Loss : RepetitionResult::Win;
+    }
+    return RepetitionResult::Draw;
+}
@@ -2,20 +2,67 @@
 #define CHESSRULES_H
 
 #include "Board.h"
+#include "Move.h"
+#include "Position.h"
+#include "MoveList.h"
 #include <QList>
 #include <QPoint>
 
+// 走法生成类型
+enum class MoveGenType {
+    All,        // 全部走法
+    Captures,   // 只生成吃子
+    Quiets      // 只生成不吃子的走法
+};
+
+// 重复局面的裁决（以当前走子方为视角）
+enum class RepetitionResult {
+    None,   // 没有重复
+    Draw,   // 双方都不犯规（或都犯规），判和
+    Win,    // 对方长将/长捉，对方判负
+    Loss    // 己方长将/长捉，己方判负
+};
+
 // 走棋规则引擎（静态类）
+//
+// 走法与攻击判断均基于 Bitboard 预计算表：车炮按行/列占用位查表，
+// 马象按马腿/象眼表判断阻挡，生成代价与真实走法数成正比。
 class ChessRules
 {
 public:
     // 检查移动是否合法（不考虑将军）
     static bool isValidMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol);
 
-    // 获取指定棋子的所有合法移动
+    // 获取指定棋子的所有合法移动（供界面使用，QPoint 为 (列, 行)）
     static QList<QPoint> getLegalMoves(const Board &board, int row, int col);
 
-    // 检查是否将军
+    // 获取指定棋子的所有合法移动（不分配内存，供评估等热路径使用）
+    static void getLegalMoves(const Board &board, int row, int col, MoveList &moves);
+
+    // 棋子按走法规则可到达的格子（不含己方棋子，不检查送将）
+    static BitMask pseudoTargets(const Board &board, int square);
+
+    // 棋子攻击（对己方棋子即保护）的格子：与 pseudoTargets 相比包含己方棋子，
+    // 炮只计隔炮架可吃到的格子，不计不吃子时可走的空位
+    static BitMask attackTargets(const Board &board, int square);
+
+    // 生成指定颜色的全部伪合法走法（不检查送将，由搜索在走子后再判断）
+    static void generatePseudoLegalMoves(const Board &board, PieceColor color, MoveList &moves,
+                                         MoveGenType type = MoveGenType::All);
+
+    // 走法是否符合走子方的走法规则（用于验证置换表/杀手走法，不检查送将）
+    static bool isPseudoLegal(const Board &board, PieceColor color, const AIMove &move);
+
+    // 格子是否受到指定颜色棋子的攻击
+    static bool isSquareAttacked(const Board &board, int square, PieceColor byColor);
+
+    // 指定颜色中能吃到 square 的全部棋子（车炮按当前炮架、马按马腿、象按象眼判断，不检查送将）
+    static BitMask attackersTo(const Board &board, int square, PieceColor byColor);
+
+    // 将帅是否照面（同列且中间无子）
+    static bool isKingsFacing(const Board &board);
+
+    // 检查是否将军（包括将帅照面）
     static bool isInCheck(const Board &board, PieceColor kingColor);
 
     // 检查移动后是否会导致自己被将军
@@ -30,19 +77,25 @@ public:
     // 检查是否有合法走法
     static bool hasLegalMoves(const Board &board, PieceColor color);
 
+    // 当前局面重复时按长将、长捉规则裁决：
+    // 循环内一方每步都将军而另一方不是，长将方负；双方都不长将时，
+    // 一方每步都将军或捉子而另一方不是，长捉方负；其余情况判和
+    static RepetitionResult judgeRepetition(const Position &position);
+
 private:
-    // 各个棋子的移动规则
-    static bool isValidKingMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color);
-    static bool isValidAdvisorMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color);
-    static bool isValidElephantMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color);
-    static bool isValidHorseMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol);
-    static bool isValidRookMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol);
-    static bool isValidCannonMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol);
-    static bool isValidPawnMove(const Board &board, int fromRow, int fromCol, int toRow, int toCol, PieceColor color);
-
-    // 辅助函数
-    static bool isPathClear(const Board &board, int fromRow, int fromCol, int toRow, int toCol);
-    static int countPiecesBetween(const Board &board, int fromRow, int fromCol, int toRow, int toCol);
+    // 辅助函数：把行/列内的位展开为格子掩码
+    static void addRankBits(BitMask &mask, int row, quint16 bits);
+    static void addFileBits(BitMask &mask, int col, quint16 bits);
+
+    // 辅助函数：按步进表收集目标格（block 非空表示被马腿/象眼阻挡）
+    static void addSteps(BitMask &mask, const Board &board, const Bitboard::StepList &steps);
+
+    // 辅助函数：收集能吃到 square 的指定颜色棋子（isSquareAttacked 与 attackersTo 共用），
+    // stopAtFirst 为 true 时找到第一个攻击者即返回
+    static BitMask collectAttackers(const Board &board, int square, PieceColor byColor, bool stopAtFirst);
+
+    // 辅助函数：刚从 fromSq 走到 toSq 的棋子是否在捉子（board 为走子后的局面）
+    static bool isChase(Board &board, int fromSq, int toSq);
 };
 
 #endif // CHESSRULES_H
@@ -0,0 +1,23 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+// 移动结构（包含评分）
+struct AIMove {
+    int fromRow, fromCol;
+    int toRow, toCol;
+    int score;
+
+    AIMove() : fromRow(-1), fromCol(-1), toRow(-1), toCol(-1), score(0) {}
+    AIMove(int fr, int fc, int tr, int tc, int s = 0)
+        : fromRow(fr), fromCol(fc), toRow(tr), toCol(tc), score(s) {}
+
+    bool isValid() const { return fromRow >= 0 && fromCol >= 0 && toRow >= 0 && toCol >= 0; }
+
+    // 比较两个走法（只比较坐标，不比较评分）
+    bool operator==(const AIMove &other) const {
+        return fromRow == other.fromRow && fromCol == other.fromCol
+            && toRow == other.toRow && toCol == other.toCol;
+    }
+};
+
+#endif // MOVE_H
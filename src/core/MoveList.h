@@ -0,0 +1,52 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "Move.h"
+#include <QtGlobal>
+#include <QDebug>
+
+// 定长走法列表
+//
+// 走法直接存放在对象内部的数组里，作为局部变量时完全位于栈上，
+// 搜索中生成走法不会产生任何堆分配。
+//
+// 容量按正常子力下单方伪合法走法数的上限确定：车、炮每个最多 9+8=17 步，
+// 马 8 步，士、象、将各 4 步，兵 3 步，合计 2*17+2*17+2*8+2*4+2*4+4+5*3 = 119 < 128。
+// 摆棋局面可能超出正常子力，超出容量的走法会被丢弃并输出警告，不会越界写入。
+class MoveList
+{
+public:
+    static const int CAPACITY = 128;
+
+    MoveList() : m_size(0) {}
+
+    void append(const AIMove &move) {
+        if (Q_UNLIKELY(m_size >= CAPACITY)) {
+            qWarning() << "MoveList: 走法数超出容量" << CAPACITY << "，丢弃多余走法";
+            return;
+        }
+        m_moves[m_size++] = move;
+    }
+
+    void clear() { m_size = 0; }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    AIMove &operator[](int index) { return m_moves[index]; }
+    const AIMove &operator[](int index) const { return m_moves[index]; }
+
+    AIMove *begin() { return m_moves; }
+    AIMove *end() { return m_moves + m_size; }
+    const AIMove *begin() const { return m_moves; }
+    const AIMove *end() const { return m_moves + m_size; }
+
+private:
+    // 放在匿名联合中，构造列表时不逐个默认构造 128 个走法
+    union {
+        AIMove m_moves[CAPACITY];
+    };
+    int m_size;
+};
+
+#endif // MOVELIST_H
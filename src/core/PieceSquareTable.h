@@ -0,0 +1,284 @@
+#ifndef PIECESQUARETABLE_H
+#define PIECESQUARETABLE_H
+
+#include "Board.h"
+#include <QtTypes>
+
+// 子力与位置价值表（中局/残局两套）
+//
+// 棋子价值 = 基础子力 + 位置分，位置表以己方底线为第0行给出（九宫在0~2行，
+// 5行起为过河），黑方直接取棋盘行号，红方在棋盘下方，按行翻转。
+// 合并表在编译期按 [格子][棋子编码] 展开（红方为正、黑方为负），
+// Position 走子时据此增量维护两套子力位置分和局面阶段，
+// 评估时按阶段在中局与残局分数之间插值，无需逐格扫描。
+namespace PieceSquareTable {
+
+// 局面阶段：双方车、马、炮按权重累加，满值为开局，0 为无车马炮的残局
+constexpr int phaseWeight(PieceType type)
+{
+    switch (type) {
+    case PieceType::Rook:
+        return 4;
+    case PieceType::Horse:
+    case PieceType::Cannon:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+inline constexpr int TOTAL_PHASE = 2 * (2 * 4 + 2 * 2 + 2 * 2);
+
+// 按阶段在中局值与残局值之间插值
+constexpr int taper(int mg, int eg, int phase)
+{
+    return (mg * phase + eg * (TOTAL_PHASE - phase)) / TOTAL_PHASE;
+}
+
+// 中局位置分
+inline constexpr int PAWN[Board::ROWS][Board::COLS] = {
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0, -2,  0,  4,  0, -2,  0,  0},
+    { 2,  0,  8,  0,  8,  0,  8,  0,  2},
+    { 6,  12, 18, 18, 20, 18, 18, 12, 6},
+    { 10, 20, 30, 34, 40, 34, 30, 20, 10},
+    { 14, 26, 42, 60, 80, 60, 42, 26, 14},
+    { 18, 36, 56, 80, 120, 80, 56, 36, 18},
+    { 0,  3,  6,  9,  12,  9,  6,  3,  0}
+};
+
+inline constexpr int ADVISOR[Board::ROWS][Board::COLS] = {
+    { 0,  0,  0, 20,  0, 20,  0,  0,  0},
+    { 0,  0,  0,  0, 23,  0,  0,  0,  0},
+    { 0,  0,  0, 20,  0, 20,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+inline constexpr int ELEPHANT[Board::ROWS][Board::COLS] = {
+    { 0,  0, 20,  0,  0,  0, 20,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    {18,  0,  0,  0, 23,  0,  0,  0, 18},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0, 20,  0,  0,  0, 20,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+inline constexpr int HORSE[Board::ROWS][Board::COLS] = {
+    { 0, -3,  5,  4,  2,  4,  5, -3,  0},
+    {-3,  2,  4,  6,  10, 6,  4,  2, -3},
+    { 4,  6, 12, 11, 15, 11, 12, 6,  4},
+    { 2,  6,  8, 11, 11, 11,  8,  6,  2},
+    { 2,  12, 11, 15, 16, 15, 11, 12, 2},
+    { 0,  5,  7,  7,  14,  7,  7,  5,  0},
+    {-5,  2,  4,  8,  8,  8,  4,  2, -5},
+    {-6,  3,  2,  5,  4,  5,  2,  3, -6},
+    {-8, -3,  1,  4,  4,  4,  1, -3, -8},
+    {-10,-8, -6, -3, -1, -3, -6, -8, -10}
+};
+
+inline constexpr int ROOK[Board::ROWS][Board::COLS] = {
+    {-6,  5,  8,  8,  8,  8,  8,  5, -6},
+    { 6, 8,   10, 14, 15, 14, 10,  8,  6},
+    { 4,  6,  8,  12, 12, 12,  8,  6,  4},
+    {12, 16, 16, 20, 20, 20, 16, 16, 12},
+    {10, 14, 15, 17, 20, 17, 15, 14, 10},
+    { 6, 11, 13, 15, 16, 15, 13, 11,  6},
+    { 4, 6,   9,  10, 11, 10, 9,   6,  4},
+    { 2, 4,   7,  7,  8,  7,  7,   4,  2},
+    { 0, 3,   5,  5,  6,  5,  5,   3,  0},
+    {-4, 2,   4,  4,  5,  4,  4,   2, -4}
+};
+
+inline constexpr int CANNON[Board::ROWS][Board::COLS] = {
+    { 0,  0,  1,  0,  3,  0,  1,  0,  0},
+    { 0,  2,  4,  3,  4,  3,  4,  2,  0},
+    { 1,  0,  7,  4,  4,  4,  7,  0,  1},
+    { 0,  0,  7,  4,  4,  4,  7,  0,  0},
+    { 0,  1,  6,  7,  7,  7,  6,  1,  0},
+    {-1,  1,  2,  7,  8,  7,  2,  1, -1},
+    { 0,  3,  4,  4,  3,  4,  4,  3,  0},
+    { 0,  2,  2,  2,  2,  2,  2,  2,  0},
+    { 0,  1,  2,  3,  3,  3,  2,  1,  0},
+    { 0,  0,  1,  1,  2,  1,  1,  0,  0}
+};
+
+inline constexpr int KING[Board::ROWS][Board::COLS] = {
+    { 0,  0,  0,  8,  8,  8,  0,  0,  0},
+    { 0,  0,  0,  9,  9,  9,  0,  0,  0},
+    { 0,  0,  0, 10, 10, 10,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+// 残局位置分（其余棋子沿用中局表）
+// 兵：过河后价值普遍提高，不再集中于九宫附近，沉底兵作用很小
+inline constexpr int PAWN_EG[Board::ROWS][Board::COLS] = {
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  4,  0,  0,  0,  0},
+    { 4,  0,  8,  0, 10,  0,  8,  0,  4},
+    {30, 34, 38, 42, 44, 42, 38, 34, 30},
+    {34, 40, 46, 52, 56, 52, 46, 40, 34},
+    {36, 44, 52, 60, 66, 60, 52, 44, 36},
+    {36, 44, 54, 64, 70, 64, 54, 44, 36},
+    { 6,  8, 10, 12, 14, 12, 10,  8,  6}
+};
+
+// 将帅：残局中居中、升起助攻更积极
+inline constexpr int KING_EG[Board::ROWS][Board::COLS] = {
+    { 0,  0,  0,  2,  6,  2,  0,  0,  0},
+    { 0,  0,  0,  6, 12,  6,  0,  0,  0},
+    { 0,  0,  0,  8, 14,  8,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+// 基础子力价值（中局）
+constexpr int baseValue(PieceType type)
+{
+    switch (type) {
+    case PieceType::King:
+        return 10000;  // 将/帅
+    case PieceType::Rook:
+        return 1000;   // 车
+    case PieceType::Horse:
+        return 350;    // 马
+    case PieceType::Cannon:
+        return 350;    // 炮
+    case PieceType::Advisor:
+        return 200;    // 士
+    case PieceType::Elephant:
+        return 200;    // 象
+    case PieceType::Pawn:
+        return 100;    // 兵
+    default:
+        return 0;
+    }
+}
+
+// 残局基础子力价值：马的威力上升而炮缺少炮架，士象的防守作用下降
+constexpr int baseValueEg(PieceType type)
+{
+    switch (type) {
+    case PieceType::Horse:
+        return 380;
+    case PieceType::Cannon:
+        return 320;
+    case PieceType::Advisor:
+    case PieceType::Elephant:
+        return 180;
+    default:
+        return baseValue(type);
+    }
+}
+
+// 中局位置分
+constexpr int positionValue(PieceType type, int posRow, int col)
+{
+    switch (type) {
+    case PieceType::Pawn:
+        return PAWN[posRow][col];
+    case PieceType::Advisor:
+        return ADVISOR[posRow][col];
+    case PieceType::Elephant:
+        return ELEPHANT[posRow][col];
+    case PieceType::Horse:
+        return HORSE[posRow][col];
+    case PieceType::Rook:
+        return ROOK[posRow][col];
+    case PieceType::Cannon:
+        return CANNON[posRow][col];
+    case PieceType::King:
+        return KING[posRow][col];
+    default:
+        return 0;
+    }
+}
+
+// 残局位置分
+constexpr int positionValueEg(PieceType type, int posRow, int col)
+{
+    switch (type) {
+    case PieceType::Pawn:
+        return PAWN_EG[posRow][col];
+    case PieceType::King:
+        return KING_EG[posRow][col];
+    default:
+        return positionValue(type, posRow, col);
+    }
+}
+
+// 棋盘行号转为位置表行号（以己方底线为第0行）：红方在下方需要翻转
+constexpr int tableRow(int row, PieceColor color)
+{
+    return (color == PieceColor::Red) ? (Board::ROWS - 1 - row) : row;
+}
+
+// 棋子价值（基础子力 + 位置分，不分正负）
+constexpr int pieceValue(PieceType type, int row, int col, PieceColor color)
+{
+    return baseValue(type) + positionValue(type, tableRow(row, color), col);
+}
+
+constexpr int pieceValueEg(PieceType type, int row, int col, PieceColor color)
+{
+    return baseValueEg(type) + positionValueEg(type, tableRow(row, color), col);
+}
+
+struct Table {
+    // [格子][棋子编码]，红方为正、黑方为负，空位为0
+    int mg[Board::SQUARES][16];
+    int eg[Board::SQUARES][16];
+};
+
+constexpr Table generateTable()
+{
+    Table table{};
+    for (int square = 0; square < Board::SQUARES; ++square) {
+        for (int code = 1; code < 16; ++code) {
+            PieceType type = static_cast<PieceType>(code & 7);
+            bool black = (code & Board::BLACK_FLAG) != 0;
+            int row = square / Board::COLS;
+            int col = square % Board::COLS;
+            PieceColor color = black ? PieceColor::Black : PieceColor::Red;
+            int mg = pieceValue(type, row, col, color);
+            int eg = pieceValueEg(type, row, col, color);
+            table.mg[square][code] = black ? -mg : mg;
+            table.eg[square][code] = black ? -eg : eg;
+        }
+    }
+    return table;
+}
+
+inline constexpr Table TABLE = generateTable();
+
+// 格子上棋子的有符号价值（红方视角）
+inline int mgValue(int square, quint8 code) { return TABLE.mg[square][code]; }
+inline int egValue(int square, quint8 code) { return TABLE.eg[square][code]; }
+
+} // namespace PieceSquareTable
+
+#endif // PIECESQUARETABLE_H
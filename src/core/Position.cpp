@@ -1,12 +1,22 @@
 #include "Position.h"
+#include "Zobrist.h"
+#include <algorithm>
 #include <QDebug>
 
 Position::Position()
     : m_currentTurn(PieceColor::Red)
     , m_halfMoveClock(0)
     , m_fullMoveNumber(1)
+    , m_zobristKey(0)
+    , m_mgScore(0)
+    , m_egScore(0)
+    , m_phase(0)
+    , m_structureKey(0)
+    , m_historyCount(0)
+    , m_historyHigh(0)
 {
     m_board.initializeStartPosition();
+    recomputeState();
 }
 
 Position::Position(const Board &board)
@@ -14,12 +24,214 @@ Position::Position(const Board &board)
     , m_currentTurn(PieceColor::Red)
     , m_halfMoveClock(0)
     , m_fullMoveNumber(1)
+    , m_zobristKey(0)
+    , m_mgScore(0)
+    , m_egScore(0)
+    , m_phase(0)
+    , m_structureKey(0)
+    , m_historyCount(0)
+    , m_historyHigh(0)
 {
+    recomputeState();
+}
+
+void Position::setCurrentTurn(PieceColor color)
+{
+    if (m_currentTurn != color) {
+        switchTurn();
+    }
 }
 
 void Position::switchTurn()
 {
     m_currentTurn = (m_currentTurn == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+    m_zobristKey ^= Zobrist::sideKey();
+}
+
+void Position::recomputeState()
+{
+    quint64 key = 0;
+    quint64 structureKey = 0;
+    int mg = 0;
+    int eg = 0;
+    int phase = 0;
+    for (int square = 0; square < Board::SQUARES; ++square) {
+        quint8 code = m_board.pieceCodeAt(square);
+        if (code != Board::EMPTY) {
+            key ^= Zobrist::pieceKey(square, code);
+            if (isStructurePiece(code)) {
+                structureKey ^= Zobrist::pieceKey(square, code);
+            }
+            mg += PieceSquareTable::mgValue(square, code);
+            eg += PieceSquareTable::egValue(square, code);
+            phase += PieceSquareTable::phaseWeight(Board::pieceTypeOf(code));
+        }
+    }
+    if (m_currentTurn == PieceColor::Black) {
+        key ^= Zobrist::sideKey();
+    }
+    m_zobristKey = key;
+    m_mgScore = mg;
+    m_egScore = eg;
+    m_phase = phase;
+    m_structureKey = structureKey;
+
+    // 棋盘被直接修改，之前的历史局面不再可比
+    m_historyCount = 0;
+    m_historyHigh = 0;
+}
+
+void Position::makeMove(const AIMove &move, UndoInfo &undo)
+{
+    int fromSq = Board::toSquare(move.fromRow, move.fromCol);
+    int toSq = Board::toSquare(move.toRow, move.toCol);
+
+    undo.halfMoveClock = m_halfMoveClock;
+    undo.fullMoveNumber = m_fullMoveNumber;
+    undo.zobristKey = m_zobristKey;
+    undo.mgScore = m_mgScore;
+    undo.egScore = m_egScore;
+    undo.phase = m_phase;
+    undo.structureKey = m_structureKey;
+    quint8 moving = m_board.pieceCodeAt(fromSq);
+    bool isPawn = Board::pieceTypeOf(moving) == PieceType::Pawn;
+
+    // 吃子或兵卒前进之后，之前的局面不可能再出现（兵卒平移可以走回原处）
+    bool irreversible = !m_board.isEmpty(move.toRow, move.toCol) || (isPawn && move.fromRow != move.toRow);
+    pushHistory(static_cast<quint8>(fromSq), static_cast<quint8>(toSq), irreversible);
+
+    undo.captured = m_board.makeMove(fromSq, toSq);
+
+    // 增量更新哈希：移出起点、放入终点、移除被吃棋子
+    m_zobristKey ^= Zobrist::pieceKey(fromSq, moving) ^ Zobrist::pieceKey(toSq, moving);
+    if (undo.captured != Board::EMPTY) {
+        m_zobristKey ^= Zobrist::pieceKey(toSq, undo.captured);
+    }
+
+    // 结构哈希只在将帅、士、象、兵移动或被吃时变化
+    if (isStructurePiece(moving)) {
+        m_structureKey ^= Zobrist::pieceKey(fromSq, moving) ^ Zobrist::pieceKey(toSq, moving);
+    }
+    if (undo.captured != Board::EMPTY && isStructurePiece(undo.captured)) {
+        m_structureKey ^= Zobrist::pieceKey(toSq, undo.captured);
+    }
+
+    // 增量更新子力位置分：同样只涉及起点、终点和被吃棋子；阶段只在吃子时变化
+    m_mgScore += PieceSquareTable::mgValue(toSq, moving) - PieceSquareTable::mgValue(fromSq, moving)
+                 - PieceSquareTable::mgValue(toSq, undo.captured);
+    m_egScore += PieceSquareTable::egValue(toSq, moving) - PieceSquareTable::egValue(fromSq, moving)
+                 - PieceSquareTable::egValue(toSq, undo.captured);
+    m_phase -= PieceSquareTable::phaseWeight(Board::pieceTypeOf(undo.captured));
+
+    // 吃子或兵卒移动时重置半回合计数
+    if (undo.captured != Board::EMPTY || isPawn) {
+        m_halfMoveClock = 0;
+    } else {
+        ++m_halfMoveClock;
+    }
+
+    // 黑方走完后全回合数加一
+    if (m_currentTurn == PieceColor::Black) {
+        ++m_fullMoveNumber;
+    }
+
+    switchTurn();
+}
+
+void Position::unmakeMove(const AIMove &move, const UndoInfo &undo)
+{
+    m_currentTurn = (m_currentTurn == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+
+    m_board.unmakeMove(Board::toSquare(move.fromRow, move.fromCol),
+                       Board::toSquare(move.toRow, move.toCol),
+                       undo.captured);
+
+    m_halfMoveClock = undo.halfMoveClock;
+    m_fullMoveNumber = undo.fullMoveNumber;
+    m_zobristKey = undo.zobristKey;
+    m_mgScore = undo.mgScore;
+    m_egScore = undo.egScore;
+    m_phase = undo.phase;
+    m_structureKey = undo.structureKey;
+    if (m_historyCount > 0) --m_historyCount;
+}
+
+void Position::makeNullMove(UndoInfo &undo)
+{
+    undo.captured = Board::EMPTY;
+    undo.halfMoveClock = m_halfMoveClock;
+    undo.fullMoveNumber = m_fullMoveNumber;
+    undo.zobristKey = m_zobristKey;
+    undo.mgScore = m_mgScore;
+    undo.egScore = m_egScore;
+    undo.phase = m_phase;
+    undo.structureKey = m_structureKey;
+    pushHistory(NULL_SQUARE, NULL_SQUARE, false);
+
+    switchTurn();
+}
+
+void Position::unmakeNullMove(const UndoInfo &undo)
+{
+    m_currentTurn = (m_currentTurn == PieceColor::Red) ? PieceColor::Black : PieceColor::Red;
+
+    m_halfMoveClock = undo.halfMoveClock;
+    m_fullMoveNumber = undo.fullMoveNumber;
+    m_zobristKey = undo.zobristKey;
+    if (m_historyCount > 0) --m_historyCount;
+}
+
+void Position::pushHistory(quint8 fromSq, quint8 toSq, bool irreversible)
+{
+    HistoryEntry &entry = m_history[m_historyCount & (HISTORY_SIZE - 1)];
+    entry.key = m_zobristKey;
+    entry.fromSq = fromSq;
+    entry.toSq = toSq;
+    entry.irreversible = irreversible;
+    ++m_historyCount;
+    m_historyHigh = std::max(m_historyHigh, m_historyCount);
+}
+
+int Position::validHistoryCount() const
+{
+    // 撤销走法只回退计数，不恢复被覆盖的槽位：
+    // 下标在 m_historyHigh - HISTORY_SIZE 之前的表项已被之后压入的表项覆盖
+    return std::min(m_historyCount, HISTORY_SIZE - (m_historyHigh - m_historyCount));
+}
+
+int Position::repetitionCycle() const
+{
+    // 吃子和兵卒前进不可逆，只需查到最近一次这类走法为止。
+    // 不按半回合计数截断：兵卒移动都会清零该计数，而过河兵的平移是可逆的，
+    // 用它截断会漏掉兵卒左右平移构成的长将、长捉
+    int window = validHistoryCount();
+
+    for (int plies = 1; plies <= window; ++plies) {
+        const HistoryEntry &entry = m_history[(m_historyCount - plies) & (HISTORY_SIZE - 1)];
+        if (entry.fromSq == NULL_SQUARE || entry.irreversible) {
+            break;
+        }
+        // 同一方走棋的局面相隔偶数步，最短的循环是双方各走两步
+        if (plies >= 4 && plies % 2 == 0 && entry.key == m_zobristKey) {
+            return plies;
+        }
+    }
+    return 0;
+}
+
+bool Position::historyMove(int pliesAgo, int &fromSq, int &toSq) const
+{
+    if (pliesAgo < 1 || pliesAgo > validHistoryCount()) {
+        return false;
+    }
+
+    const HistoryEntry &entry = m_history[(m_historyCount - pliesAgo) & (HISTORY_SIZE - 1)];
+    if (entry.fromSq == NULL_SQUARE) {
+        return false;
+    }
+    fromSq = entry.fromSq;
+    toSq = entry.toSq;
+    return true;
 }
 
 QString Position::toFen() const
@@ -31,16 +243,16 @@ QString Position::toFen() const
         int emptyCount = 0;
 
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = m_board.pieceAt(row, col);
+            ChessPiece piece = m_board.pieceAt(row, col);
 
-            if (piece && piece->isValid()) {
+            if (piece.isValid()) {
                 // 如果有空格计数，先添加数字
                 if (emptyCount > 0) {
                     fen += QString::number(emptyCount);
                     emptyCount = 0;
                 }
                 // 添加棋子字符
-                fen += piece->fenChar();
+                fen += piece.fenChar();
             } else {
                 ++emptyCount;
             }
@@ -131,6 +343,7 @@ bool Position::fromFen(const QString &fen)
         m_fullMoveNumber = parts[5].toInt();
     }
 
+    recomputeState();
     return true;
 }
 
@@ -142,14 +355,14 @@ QString Position::toBoardFen() const
         int emptyCount = 0;
 
         for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = m_board.pieceAt(row, col);
+            ChessPiece piece = m_board.pieceAt(row, col);
 
-            if (piece && piece->isValid()) {
+            if (piece.isValid()) {
                 if (emptyCount > 0) {
                     fen += QString::number(emptyCount);
                     emptyCount = 0;
                 }
-                fen += piece->fenChar();
+                fen += piece.fenChar();
             } else {
                 ++emptyCount;
             }
@@ -2,7 +2,22 @@
 #define POSITION_H
 
 #include "Board.h"
+#include "Move.h"
+#include "PieceSquareTable.h"
 #include <QString>
+#include <algorithm>
+
+// 走子撤销信息：makeMove 时记录，unmakeMove 时据此恢复局面
+struct UndoInfo {
+    quint8 captured;        // 被吃棋子编码（Board::EMPTY 表示未吃子）
+    int halfMoveClock;      // 走子前的半回合计数
+    int fullMoveNumber;     // 走子前的全回合计数
+    quint64 zobristKey;     // 走子前的哈希键
+    int mgScore;            // 走子前的中局子力位置分
+    int egScore;            // 走子前的残局子力位置分
+    int phase;              // 走子前的局面阶段
+    quint64 structureKey;   // 走子前的结构哈希键
+};
 
 // 局面类 - 表示完整的游戏状态
 class Position
@@ -12,12 +27,13 @@ public:
     explicit Position(const Board &board);
 
     // 获取棋盘
+    // 注意：直接修改棋盘后需调用 recomputeState()，走子请使用 makeMove
     Board& board() { return m_board; }
     const Board& board() const { return m_board; }
 
     // 当前回合
     PieceColor currentTurn() const { return m_currentTurn; }
-    void setCurrentTurn(PieceColor color) { m_currentTurn = color; }
+    void setCurrentTurn(PieceColor color);
 
     // 切换回合
     void switchTurn();
@@ -33,6 +49,54 @@ public:
     void setFullMoveNumber(int number) { m_fullMoveNumber = number; }
     void incrementFullMoveNumber() { ++m_fullMoveNumber; }
 
+    // ===== Zobrist 哈希（走子时增量更新，包含走棋方） =====
+
+    quint64 zobristKey() const { return m_zobristKey; }
+
+    // ===== 子力位置分（红方视角，走子时按 PieceSquareTable 增量更新） =====
+
+    // 按局面阶段在中局与残局分数之间插值后的子力位置分
+    int materialScore() const { return PieceSquareTable::taper(m_mgScore, m_egScore, phase()); }
+    int mgScore() const { return m_mgScore; }
+    int egScore() const { return m_egScore; }
+
+    // 局面阶段：PieceSquareTable::TOTAL_PHASE 为开局子力齐全，0 为双方都没有车马炮
+    // （吃子时增量更新，子力多于开局的摆棋局面按满值计）
+    int phase() const { return std::min(m_phase, PieceSquareTable::TOTAL_PHASE); }
+
+    // ===== 结构哈希（只含士、象、兵，不含走棋方，供评估缓存兵型和九宫结构） =====
+
+    quint64 structureKey() const { return m_structureKey; }
+
+    // 棋子是否参与结构哈希
+    static bool isStructurePiece(quint8 code) { return (STRUCTURE_TYPES >> (code & 7)) & 1; }
+
+    // 从头计算哈希键、结构哈希键和子力位置分（在直接修改棋盘后调用）
+    void recomputeState();
+
+    // ===== 走子与撤销（搜索中原地修改局面，避免逐节点复制） =====
+
+    // 执行走法（不检查合法性）：移动棋子、更新计数并切换回合
+    void makeMove(const AIMove &move, UndoInfo &undo);
+
+    // 撤销 makeMove 执行的走法
+    void unmakeMove(const AIMove &move, const UndoInfo &undo);
+
+    // 空着：只切换回合（用于空着裁剪）
+    void makeNullMove(UndoInfo &undo);
+    void unmakeNullMove(const UndoInfo &undo);
+
+    // ===== 重复局面检测 =====
+    // makeMove/makeNullMove 把走子前的哈希键和走法压入环形历史栈，unmakeMove 弹出。
+    // 吃子和兵卒前进不可逆，查找重复时只需查到最近一次这类走法为止（过河兵平移可逆，不在此列）；
+    // 从头计算哈希键（加载 FEN 等）时清空。
+
+    // 当前局面与同一方走棋的历史局面重复时，返回循环的半回合数，否则返回0（不跨越空着）
+    int repetitionCycle() const;
+
+    // 往前第 pliesAgo 步（1 表示上一步）的起点/终点格，超出历史或为空着时返回 false
+    bool historyMove(int pliesAgo, int &fromSq, int &toSq) const;
+
     // ===== FEN 格式序列化 =====
     // 中国象棋 FEN 格式示例:
     // "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1"
@@ -62,6 +126,34 @@ private:
     PieceColor m_currentTurn;   // 当前回合
     int m_halfMoveClock;        // 半回合计数
     int m_fullMoveNumber;       // 全回合计数
+    quint64 m_zobristKey;       // 局面哈希键
+    int m_mgScore;              // 中局子力位置分（红方视角）
+    int m_egScore;              // 残局子力位置分（红方视角）
+    int m_phase;                // 局面阶段（未截断）
+    quint64 m_structureKey;     // 结构哈希键
+
+    // 参与结构哈希的棋子类型（按 PieceType 取位：士、象、兵）。
+    // 结构评估不看将帅位置，将帅移动不应改变键值，否则残局中缓存几乎不会命中
+    static const int STRUCTURE_TYPES = (1 << int(PieceType::Advisor)) | (1 << int(PieceType::Elephant))
+                                     | (1 << int(PieceType::Pawn));
+
+    // 历史栈表项：走子前的哈希键与走法（空着的起点、终点都为 NULL_SQUARE）
+    struct HistoryEntry {
+        quint64 key;
+        quint8 fromSq;
+        quint8 toSq;
+        bool irreversible;  // 该走法吃子或兵卒前进
+    };
+    static const int HISTORY_SIZE = 256;     // 环形缓冲大小（2 的幂，远大于可逆走法窗口）
+    static const quint8 NULL_SQUARE = 0xFF;
+
+    void pushHistory(quint8 fromSq, quint8 toSq, bool irreversible);
+    // 可回看的历史表项数：搜索中压入又撤销的表项可能已覆盖了更早的对局历史
+    int validHistoryCount() const;
+
+    HistoryEntry m_history[HISTORY_SIZE];
+    int m_historyCount;         // 已压入的表项总数（下标对 HISTORY_SIZE 取模）
+    int m_historyHigh;          // m_historyCount 曾达到的最大值（之前的表项中有多少被覆盖）
 };
 
 #endif // POSITION_H
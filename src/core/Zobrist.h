@@ -0,0 +1,46 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "Board.h"
+#include <QtTypes>
+
+// Zobrist 哈希键表
+//
+// 键值在编译期由固定种子（splitmix64）生成：每次运行结果一致，
+// 也不存在静态初始化顺序问题。
+namespace Zobrist {
+
+struct Keys {
+    quint64 pieces[Board::SQUARES][16];  // [格子][棋子编码]，空位为0
+    quint64 blackToMove;                 // 黑方走棋时异或此键
+};
+
+constexpr quint64 splitMix64(quint64 &state)
+{
+    quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys generateKeys()
+{
+    Keys keys{};
+    quint64 state = 0x20240601ULL;  // 固定种子
+    for (int square = 0; square < Board::SQUARES; ++square) {
+        for (int code = 1; code < 16; ++code) {
+            keys.pieces[square][code] = splitMix64(state);
+        }
+    }
+    keys.blackToMove = splitMix64(state);
+    return keys;
+}
+
+inline constexpr Keys KEYS = generateKeys();
+
+inline quint64 pieceKey(int square, quint8 code) { return KEYS.pieces[square][code]; }
+inline quint64 sideKey() { return KEYS.blackToMove; }
+
+} // namespace Zobrist
+
+#endif // ZOBRIST_H
@@ -1,7 +1,6 @@
 #include "ChessBoardModel.h"
 #include <QDebug>
 #include <QRandomGenerator>
-#include <QtConcurrent/QtConcurrent>
 
 ChessBoardModel::ChessBoardModel(QObject *parent)
     : QAbstractListModel(parent)
@@ -13,6 +12,10 @@ ChessBoardModel::ChessBoardModel(QObject *parent)
     , m_aiThinking(false)
     , m_isTwoPlayerMode(false)
     , m_boardRotation(0)
+    , m_ponderEnabled(true)
+    , m_pondering(false)
+    , m_ponderHit(false)
+    , m_ponderFinished(false)
     , m_databaseManager(this)
     , m_currentGameMode("single")
 {
@@ -21,8 +24,7 @@ ChessBoardModel::ChessBoardModel(QObject *parent)
         qWarning() << "数据库初始化失败，存档功能将不可用";
     }
 
-    // 初始化为开局局面
-    m_position.board().initializeStartPosition();
+    // 初始化为开局局面（Position 默认构造即为开局）
     rebuildPiecesList();
 
     // 创建AI定时器
@@ -30,9 +32,9 @@ ChessBoardModel::ChessBoardModel(QObject *parent)
     m_aiTimer->setSingleShot(true);
     connect(m_aiTimer, &QTimer::timeout, this, &ChessBoardModel::executeAIMove);
 
-    // 创建AI任务监视器
-    m_aiWatcher = new QFutureWatcher<AIMove>(this);
-    connect(m_aiWatcher, &QFutureWatcher<AIMove>::finished, this, &ChessBoardModel::onAIFinished);
+    // 创建AI搜索会话
+    m_aiSession = new SearchSession(&m_ai, this);
+    connect(m_aiSession, &SearchSession::finished, this, &ChessBoardModel::onSearchFinished);
 
     // 连接游戏控制器信号
     connect(&m_gameController, &GameController::undoAvailableChanged, this, &ChessBoardModel::canUndoChanged);
@@ -46,6 +48,14 @@ ChessBoardModel::ChessBoardModel(QObject *parent)
     m_gameController.startNewGame(m_position.toFen());
 }
 
+ChessBoardModel::~ChessBoardModel()
+{
+    // 搜索线程使用的 m_ai 先于子对象析构，必须在这里等待后台搜索退出
+    m_aiTimer->stop();
+    m_aiSession->cancel();
+    m_aiSession->waitForFinished();
+}
+
 int ChessBoardModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
@@ -190,24 +200,21 @@ bool ChessBoardModel::movePieceToPosition(int fromIndex, int toRow, int toCol)
     }
 
     // 记录移动棋子和目标位置的棋子（用于历史记录）
-    const ChessPiece *movedPiece = m_position.board().pieceAt(fromRow, fromCol);
-    const ChessPiece *targetPiece = m_position.board().pieceAt(toRow, toCol);
-    QString capturedPiece = targetPiece ? targetPiece->chineseName() : "";
-    bool isCapture = (targetPiece != nullptr);  // 记录是否吃子
+    ChessPiece movedPiece = m_position.board().pieceAt(fromRow, fromCol);
+    ChessPiece targetPiece = m_position.board().pieceAt(toRow, toCol);
+    QString capturedPiece = targetPiece.chineseName();
+    bool isCapture = targetPiece.isValid();  // 记录是否吃子
 
-    // 执行移动
-    m_position.board().movePiece(fromRow, fromCol, toRow, toCol);
+    // 执行移动（同时切换回合、更新回合计数与哈希键）
+    UndoInfo undo;
+    m_position.makeMove(AIMove(fromRow, fromCol, toRow, toCol), undo);
 
     // 发射棋子移动信号（用于音效）
     emit pieceMoved(isCapture);
 
-    // 切换回合
-    m_position.switchTurn();
-    m_position.incrementFullMoveNumber();
-
     // 记录走棋历史（使用移动前保存的棋子信息）
-    if (movedPiece) {
-        m_gameController.recordMove(m_position, *movedPiece, fromRow, fromCol, toRow, toCol, capturedPiece);
+    if (movedPiece.isValid()) {
+        m_gameController.recordMove(m_position, movedPiece, fromRow, fromCol, toRow, toCol, capturedPiece);
     }
 
     // 更新模型（使用辅助方法）
@@ -218,6 +225,8 @@ bool ChessBoardModel::movePieceToPosition(int fromIndex, int toRow, int toCol)
 
     qDebug() << "移动成功: " << fromRow << fromCol << "->" << toRow << toCol;
 
+    onOpponentMoved(AIMove(fromRow, fromCol, toRow, toCol));
+
     // 如果AI启用且切换到黑方回合，触发AI走棋
     if (m_aiEnabled && !isRedTurn()) {
         triggerAIMove();
@@ -231,11 +240,10 @@ bool ChessBoardModel::movePieceToPosition(int fromIndex, int toRow, int toCol)
 
 void ChessBoardModel::resetBoardState()
 {
+    cancelAIMove();
+
     beginResetModel();
-    m_position.board().initializeStartPosition();
-    m_position.setCurrentTurn(PieceColor::Red);
-    m_position.setHalfMoveClock(0);
-    m_position.setFullMoveNumber(1);
+    m_position = Position();
     rebuildPiecesList();
     setLiftedPieceIndex(-1);
     endResetModel();
@@ -257,6 +265,8 @@ bool ChessBoardModel::loadFromFen(const QString &fen)
         return false;
     }
 
+    cancelAIMove();
+
     beginResetModel();
     m_position = newPosition;
     rebuildPiecesList();
@@ -290,21 +300,8 @@ void ChessBoardModel::checkGameStatus()
     QString opponentName = (currentColor == PieceColor::Red) ? "黑方" : "红方";
 
     // 首先检查双方的将/帅是否还存在
-    bool redKingExists = false;
-    bool blackKingExists = false;
-
-    for (int row = 0; row < Board::ROWS; ++row) {
-        for (int col = 0; col < Board::COLS; ++col) {
-            const ChessPiece *piece = m_position.board().pieceAt(row, col);
-            if (piece && piece->type() == PieceType::King) {
-                if (piece->color() == PieceColor::Red) {
-                    redKingExists = true;
-                } else if (piece->color() == PieceColor::Black) {
-                    blackKingExists = true;
-                }
-            }
-        }
-    }
+    bool redKingExists = m_position.board().kingSquare(PieceColor::Red) >= 0;
+    bool blackKingExists = m_position.board().kingSquare(PieceColor::Black) >= 0;
 
     // 如果某一方的将/帅被吃掉，游戏结束
     if (!redKingExists) {
@@ -410,12 +407,20 @@ void ChessBoardModel::undoMove()
     // 在双人对战模式下，悔棋只需回退1步
     int undoSteps = (m_aiEnabled && !m_isTwoPlayerMode) ? 2 : 1;
 
+    // 轮到AI走棋（AI正在思考或即将思考）时，只需撤回玩家刚走的一步
+    if (undoSteps == 2 && !isRedTurn()) {
+        undoSteps = 1;
+    }
+
     // 检查是否有足够的步数可以悔棋
     if (m_gameController.getCurrentMoveNumber() < undoSteps) {
         qDebug() << "无法悔棋：历史记录不足" << undoSteps << "步";
         return;
     }
 
+    // 局面即将改变，放弃正在进行的AI思考
+    cancelAIMove();
+
     // 执行悔棋
     for (int i = 0; i < undoSteps; ++i) {
         if (!m_gameController.undo(m_position)) {
@@ -452,6 +457,9 @@ void ChessBoardModel::redoMove()
         return;
     }
 
+    // 局面即将改变，放弃正在进行的AI思考
+    cancelAIMove();
+
     // 执行重做
     for (int i = 0; i < redoSteps; ++i) {
         if (!m_gameController.redo(m_position)) {
@@ -576,6 +584,7 @@ void ChessBoardModel::offerDraw()
 
 void ChessBoardModel::acceptDraw()
 {
+    cancelAIMove();
     m_gameStatus = "和棋 - 双方同意";
     qDebug() << "游戏结束:" << m_gameStatus;
     emit gameOver(m_gameStatus);
@@ -594,6 +603,7 @@ void ChessBoardModel::resign()
 {
     QString colorName = isRedTurn() ? "红方" : "黑方";
     QString opponentName = isRedTurn() ? "黑方" : "红方";
+    cancelAIMove();
     m_gameStatus = opponentName + "胜 - " + colorName + "认输";
     qDebug() << "游戏结束:" << m_gameStatus;
     emit checkmateDetected();  // 发射将死信号（用于音效）
@@ -609,6 +619,10 @@ void ChessBoardModel::setAiEnabled(bool enabled)
 
         qDebug() << "AI对手" << (enabled ? "启用" : "禁用");
 
+        if (!enabled) {
+            cancelAIMove();
+        }
+
         // 如果启用AI且当前是黑方回合，触发AI走棋
         if (enabled && !isRedTurn() && !m_aiThinking) {
             triggerAIMove();
@@ -619,11 +633,30 @@ void ChessBoardModel::setAiEnabled(bool enabled)
 void ChessBoardModel::setAiDifficulty(int difficulty)
 {
     AIDifficulty aiDiff = static_cast<AIDifficulty>(difficulty);
+
+    // 后台思考按旧难度搜索，结果不再适用
+    if (m_pondering) {
+        cancelAIMove();
+    }
     m_ai.setDifficulty(aiDiff);
     emit aiDifficultyChanged();
     qDebug() << "AI难度设置为:" << difficulty;
 }
 
+void ChessBoardModel::setPonderEnabled(bool enabled)
+{
+    if (m_ponderEnabled != enabled) {
+        m_ponderEnabled = enabled;
+        emit ponderEnabledChanged();
+
+        qDebug() << "后台思考" << (enabled ? "启用" : "禁用");
+
+        if (!enabled && m_pondering) {
+            cancelAIMove();
+        }
+    }
+}
+
 void ChessBoardModel::setIsTwoPlayerMode(bool enabled)
 {
     if (m_isTwoPlayerMode != enabled) {
@@ -687,21 +720,103 @@ void ChessBoardModel::executeAIMove()
     m_aiThinking = true;
     emit aiThinkingChanged();
 
+    // 后台思考命中：搜索早已在进行，直接使用（或等待）它的结果
+    if (m_ponderHit) {
+        m_pondering = false;
+        m_ponderHit = false;
+        if (m_ponderFinished) {
+            qDebug() << "后台思考已完成，直接走棋";
+            AIMove result = m_ponderResult;
+            onAIFinished(result);
+        } else {
+            qDebug() << "后台思考命中，继续当前搜索...";
+        }
+        return;
+    }
+
     qDebug() << "AI开始思考...";
 
-    // 在后台线程中执行AI思考
-    QFuture<AIMove> future = QtConcurrent::run([this]() {
-        return m_ai.getBestMove(m_position);
-    });
+    // 在后台线程中搜索当前局面的快照
+    m_aiSession->start(m_position);
+}
 
-    m_aiWatcher->setFuture(future);
+void ChessBoardModel::onSearchFinished(const AIMove &bestMove)
+{
+    // 后台思考的结果先保存，等玩家走棋后再决定是否使用
+    if (m_pondering) {
+        m_ponderFinished = true;
+        m_ponderResult = bestMove;
+        return;
+    }
+
+    onAIFinished(bestMove);
 }
 
-void ChessBoardModel::onAIFinished()
+void ChessBoardModel::startPondering()
 {
-    // 获取AI思考结果
-    AIMove bestMove = m_aiWatcher->result();
+    if (!m_ponderEnabled || !m_aiEnabled || m_isTwoPlayerMode || !isRedTurn()) {
+        return;
+    }
+    if (m_gameStatus.contains("胜") || m_gameStatus.contains("和棋")) {
+        return;
+    }
 
+    AIMove predicted = m_ai.getPonderMove(m_position);
+    if (!predicted.isValid()) {
+        return;
+    }
+
+    // 在预测应着之后的局面上提前搜索，与正常思考使用相同的深度
+    Position ponderPosition = m_position;
+    UndoInfo undo;
+    ponderPosition.makeMove(predicted, undo);
+
+    m_pondering = true;
+    m_ponderHit = false;
+    m_ponderFinished = false;
+    m_ponderMove = predicted;
+    m_ponderResult = AIMove();
+    m_aiSession->start(ponderPosition);
+
+    qDebug() << "后台思考：预测玩家走" << predicted.fromRow << predicted.fromCol
+             << "->" << predicted.toRow << predicted.toCol;
+}
+
+void ChessBoardModel::onOpponentMoved(const AIMove &move)
+{
+    if (!m_pondering) {
+        return;
+    }
+
+    if (move == m_ponderMove) {
+        // 命中：保留后台搜索，它的局面就是现在的局面
+        m_ponderHit = true;
+        qDebug() << "后台思考命中";
+    } else {
+        // 未命中：放弃后台搜索，按实际局面重新思考
+        qDebug() << "后台思考未命中";
+        cancelAIMove();
+    }
+}
+
+void ChessBoardModel::cancelAIMove()
+{
+    m_aiTimer->stop();
+    m_aiSession->cancel();
+
+    m_pondering = false;
+    m_ponderHit = false;
+    m_ponderFinished = false;
+
+    if (m_aiThinking) {
+        m_aiThinking = false;
+        emit aiThinkingChanged();
+        qDebug() << "已取消AI思考";
+    }
+}
+
+void ChessBoardModel::onAIFinished(const AIMove &bestMove)
+{
     m_aiThinking = false;
     emit aiThinkingChanged();
 
@@ -720,24 +835,21 @@ void ChessBoardModel::onAIFinished()
     int toCol = bestMove.toCol;
 
     // 记录移动棋子和目标位置的棋子
-    const ChessPiece *movedPiece = m_position.board().pieceAt(fromRow, fromCol);
-    const ChessPiece *targetPiece = m_position.board().pieceAt(toRow, toCol);
-    QString capturedPiece = targetPiece ? targetPiece->chineseName() : "";
-    bool isCapture = (targetPiece != nullptr);  // 记录是否吃子
+    ChessPiece movedPiece = m_position.board().pieceAt(fromRow, fromCol);
+    ChessPiece targetPiece = m_position.board().pieceAt(toRow, toCol);
+    QString capturedPiece = targetPiece.chineseName();
+    bool isCapture = targetPiece.isValid();  // 记录是否吃子
 
-    // 执行移动
-    m_position.board().movePiece(fromRow, fromCol, toRow, toCol);
+    // 执行移动（同时切换回合、更新回合计数与哈希键）
+    UndoInfo undo;
+    m_position.makeMove(AIMove(fromRow, fromCol, toRow, toCol), undo);
 
     // 发射棋子移动信号（用于音效）
     emit pieceMoved(isCapture);
 
-    // 切换回合
-    m_position.switchTurn();
-    m_position.incrementFullMoveNumber();
-
     // 记录走棋历史
-    if (movedPiece) {
-        m_gameController.recordMove(m_position, *movedPiece, fromRow, fromCol, toRow, toCol, capturedPiece);
+    if (movedPiece.isValid()) {
+        m_gameController.recordMove(m_position, movedPiece, fromRow, fromCol, toRow, toCol, capturedPiece);
     }
 
     // 更新模型（使用辅助方法）
@@ -750,11 +862,14 @@ void ChessBoardModel::onAIFinished()
     performAutoSave();
 
     qDebug() << "AI走棋完成";
+
+    // 玩家思考期间，按预测的应着提前搜索
+    startPondering();
 }
 
 // 辅助方法：执行移动并更新模型
 void ChessBoardModel::updateModelAfterMove(int fromRow, int fromCol, int toRow, int toCol,
-                                            const ChessPiece *movedPiece, const ChessPiece *targetPiece)
+                                            const ChessPiece &movedPiece, const ChessPiece &targetPiece)
 {
     // 找到移动的棋子在列表中的索引
     int fromIndex = -1;
@@ -767,7 +882,7 @@ void ChessBoardModel::updateModelAfterMove(int fromRow, int fromCol, int toRow,
 
     // 更新模型 - 使用细粒度更新而不是重建
     // 1. 如果有被吃的棋子，先从列表中移除
-    if (targetPiece) {
+    if (targetPiece.isValid()) {
         // 找到被吃棋子在列表中的索引
         int capturedIndex = -1;
         for (int i = 0; i < m_piecesList.count(); ++i) {
@@ -790,8 +905,8 @@ void ChessBoardModel::updateModelAfterMove(int fromRow, int fromCol, int toRow,
     }
 
     // 2. 更新移动棋子的位置
-    if (fromIndex >= 0 && fromIndex < m_piecesList.count() && movedPiece) {
-        m_piecesList[fromIndex] = ChessPiece(movedPiece->type(), movedPiece->color(), toRow, toCol);
+    if (fromIndex >= 0 && fromIndex < m_piecesList.count() && movedPiece.isValid()) {
+        m_piecesList[fromIndex] = ChessPiece(movedPiece.type(), movedPiece.color(), toRow, toCol);
         QModelIndex changedIndex = index(fromIndex);
         emit dataChanged(changedIndex, changedIndex);
     }
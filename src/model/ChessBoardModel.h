@@ -5,11 +5,11 @@
 #include <QString>
 #include <QPoint>
 #include <QTimer>
-#include <QFutureWatcher>
 #include "../core/Position.h"
 #include "../core/ChessRules.h"
 #include "../core/GameController.h"
 #include "../ai/ChessAI.h"
+#include "../ai/SearchSession.h"
 #include "../db/DatabaseManager.h"
 
 // 棋盘数据模型（适配层，连接 C++ 核心和 QML UI）
@@ -28,6 +28,7 @@ class ChessBoardModel : public QAbstractListModel
     Q_PROPERTY(bool aiEnabled READ aiEnabled WRITE setAiEnabled NOTIFY aiEnabledChanged)
     Q_PROPERTY(bool aiThinking READ aiThinking NOTIFY aiThinkingChanged)
     Q_PROPERTY(int aiDifficulty READ aiDifficulty WRITE setAiDifficulty NOTIFY aiDifficultyChanged)
+    Q_PROPERTY(bool ponderEnabled READ ponderEnabled WRITE setPonderEnabled NOTIFY ponderEnabledChanged)
     Q_PROPERTY(bool isTwoPlayerMode READ isTwoPlayerMode WRITE setIsTwoPlayerMode NOTIFY isTwoPlayerModeChanged)
     Q_PROPERTY(int boardRotation READ boardRotation NOTIFY boardRotationChanged)
     Q_PROPERTY(bool hasAutoSave READ hasAutoSave NOTIFY hasAutoSaveChanged)
@@ -41,6 +42,7 @@ public:
     };
 
     explicit ChessBoardModel(QObject *parent = nullptr);
+    ~ChessBoardModel() override;
 
     // QAbstractListModel 必需的方法
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -73,6 +75,9 @@ public:
     int aiDifficulty() const { return static_cast<int>(m_ai.getDifficulty()); }
     void setAiDifficulty(int difficulty);
 
+    bool ponderEnabled() const { return m_ponderEnabled; }
+    void setPonderEnabled(bool enabled);
+
     bool isTwoPlayerMode() const { return m_isTwoPlayerMode; }
     void setIsTwoPlayerMode(bool enabled);
 
@@ -130,6 +135,7 @@ signals:
     void aiEnabledChanged();                 // AI启用状态改变
     void aiThinkingChanged();                // AI思考状态改变
     void aiDifficultyChanged();              // AI难度改变
+    void ponderEnabledChanged();             // 后台思考开关改变
     void isTwoPlayerModeChanged();           // 双人模式状态改变
     void boardRotationChanged();             // 棋盘旋转角度改变
     void hasAutoSaveChanged();               // 自动存档状态改变
@@ -145,7 +151,11 @@ private:
     void updateValidMoves();    // 更新可走位置
     void triggerAIMove();       // 触发AI走棋
     void executeAIMove();       // 执行AI走棋（在定时器中调用）
-    void onAIFinished();        // AI思考完成的槽函数
+    void onSearchFinished(const AIMove &bestMove); // 后台搜索完成的槽函数
+    void onAIFinished(const AIMove &bestMove);     // AI思考完成，执行AI走法
+    void cancelAIMove();        // 取消等待中或进行中的AI思考（局面被改变时调用）
+    void startPondering();      // AI走棋后按预测的应着在后台思考
+    void onOpponentMoved(const AIMove &move); // 玩家走棋后判断后台思考是否命中
     void performAutoSave();     // 执行自动保存
 
     // 辅助方法
@@ -153,7 +163,7 @@ private:
     void resetBoardState();     // 重置棋盘状态的通用方法
     void rotateBoardIfNeeded(); // 双人模式下旋转棋盘
     void updateModelAfterMove(int fromRow, int fromCol, int toRow, int toCol,
-                              const ChessPiece *movedPiece, const ChessPiece *targetPiece);
+                              const ChessPiece &movedPiece, const ChessPiece &targetPiece);
 
     Position m_position;              // 核心局面对象
     QList<ChessPiece> m_piecesList;   // 用于 QML 显示的棋子列表
@@ -167,7 +177,15 @@ private:
     bool m_isTwoPlayerMode;            // 是否为双人对战模式
     int m_boardRotation;               // 棋盘旋转角度（0或180）
     QTimer *m_aiTimer;                 // AI延迟定时器（避免AI瞬间走棋）
-    QFutureWatcher<AIMove> *m_aiWatcher; // AI异步任务监视器
+    SearchSession *m_aiSession;        // AI异步搜索会话
+
+    // 后台思考（在玩家思考时搜索预测应着之后的局面）
+    bool m_ponderEnabled;              // 是否启用后台思考
+    bool m_pondering;                  // 后台思考进行中，等待玩家走棋
+    bool m_ponderHit;                  // 玩家走了预测的应着，后台搜索的结果即AI走法
+    bool m_ponderFinished;             // 后台搜索已经结束
+    AIMove m_ponderMove;               // 预测的玩家应着
+    AIMove m_ponderResult;             // 后台搜索得到的AI走法
     DatabaseManager m_databaseManager; // 数据库管理器
     QString m_currentGameMode;         // 当前游戏模式（single/two）
 };